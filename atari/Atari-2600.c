@@ -0,0 +1,317 @@
+/*
+ * File: Atari-2600.c
+ *
+ * Gathers the state of every chip in the console into a single context and
+ * keeps the CPU, TIA and RIOT running in step with one another.
+ */
+
+#include <string.h>
+
+#include "Atari-2600.h"
+#include "Atari-cart.h"
+#include "../mos6507/mos6507-interpreter.h"
+
+/* Called as the TIA completes a scanline */
+static inline void atari2600_end_of_line(atari2600_t *atari)
+{
+#if ATARI_TIA_PIPELINE
+    TIA_log_push(&atari->tia_log, atari->clock, TIA_LOG_LINE, 0);
+#else
+    if (atari->line_handler) {
+        atari->line_handler(atari);
+    }
+#endif
+    atari->events[ATARI2600_EVENT_LINE] += TIA_COLOUR_CLOCK_TOTAL;
+}
+
+/* Runs the TIA up to the given master clock time, handling the end of any
+ * scanlines on the way.
+ */
+static inline void atari2600_run(atari2600_t *atari, uint64_t target)
+{
+    while (atari->clock < target) {
+        uint64_t line = atari->events[ATARI2600_EVENT_LINE];
+        uint64_t until = (target < line) ? target : line;
+
+        TIA_run(&atari->tia, (uint32_t)(until - atari->clock));
+        atari->clock = until;
+        if (atari->clock == line) {
+            atari2600_end_of_line(atari);
+        }
+    }
+}
+
+/* Runs the TIA up to the CPU's next cycle */
+static inline void atari2600_cpu_cycle(atari2600_t *atari)
+{
+    atari2600_run(atari, atari->events[ATARI2600_EVENT_CPU]);
+    atari->events[ATARI2600_EVENT_CPU] += ATARI2600_CPU_CLOCKS;
+}
+
+/* Runs the TIA and RIOT through a number of CPU cycles in one go */
+static inline void atari2600_cpu_cycles(atari2600_t *atari, uint32_t cycles)
+{
+    uint64_t cpu = atari->events[ATARI2600_EVENT_CPU];
+
+    atari2600_run(atari, cpu + (uint64_t)(cycles - 1) * ATARI2600_CPU_CLOCKS);
+    atari->events[ATARI2600_EVENT_CPU] = cpu + (uint64_t)cycles * ATARI2600_CPU_CLOCKS;
+    mos6532_run(&atari->riot, cycles);
+}
+
+/* WSYNC halts the CPU until the end of the scanline. Rather than stepping
+ * through the halted cycles, the CPU's next cycle is moved straight to the
+ * first after the line ends and the RIOT is advanced past the ones missed.
+ */
+static void atari2600_wsync(atari2600_t *atari)
+{
+    uint64_t line = atari->events[ATARI2600_EVENT_LINE];
+    uint64_t cpu = atari->events[ATARI2600_EVENT_CPU];
+    uint32_t halted;
+
+    /* On the last clock of the line the TIA is about to release it anyway */
+    if (atari->tia.colour_clock >= TIA_COLOUR_CLOCK_TOTAL || cpu > line) {
+        return;
+    }
+
+    halted = (uint32_t)((line - cpu) / ATARI2600_CPU_CLOCKS) + 1;
+    atari->events[ATARI2600_EVENT_CPU] = cpu + (uint64_t)halted * ATARI2600_CPU_CLOCKS;
+    mos6532_run(&atari->riot, halted);
+}
+
+#if MOS6507_CORE_INSTRUCTION
+/* Lets the console run on while the CPU goes round a loop polling the
+ * timer or inputs, instead of interpreting each trip around it. The skip
+ * never goes past the end of the current scanline, so anything the line
+ * handler changes (e.g. the inputs) is seen at the same point as before.
+ *
+ * Returns 0 if the CPU isn't idling.
+ */
+static int atari2600_idle(atari2600_t *atari)
+{
+    uint64_t line = atari->events[ATARI2600_EVENT_LINE];
+    uint64_t cpu = atari->events[ATARI2600_EVENT_CPU];
+    uint32_t cycles;
+
+    if (cpu > line) {
+        return 0;
+    }
+    cycles = mos6507_idle_cycles(atari, (uint32_t)((line - cpu) / ATARI2600_CPU_CLOCKS) + 1);
+    if (!cycles) {
+        return 0;
+    }
+
+    atari2600_cpu_cycles(atari, cycles);
+    return 1;
+}
+
+/* Catches the TIA and RIOT up to the given cycle of the current instruction,
+ * running all the cycles since the last access in one go.
+ *
+ * While WSYNC is held the CPU is halted, so the cycle doesn't complete until
+ * the TIA releases it at the start of the next scanline. That normally
+ * happens in a single step, see atari2600_wsync(). WSYNC is only ever
+ * written by an access, so can only be held on the first cycle here.
+ */
+void atari2600_sync(atari2600_t *atari, uint8_t cycle)
+{
+    if (atari->cycles_synced > cycle) {
+        return;
+    }
+
+    do {
+        atari2600_cpu_cycle(atari);
+    } while (TIA_get_WSYNC(&atari->tia));
+    mos6532_clock_tick(&atari->riot);
+    atari->cycles_synced++;
+
+    if (atari->cycles_synced <= cycle) {
+        atari2600_cpu_cycles(atari, cycle + 1 - atari->cycles_synced);
+        atari->cycles_synced = cycle + 1;
+    }
+}
+#endif
+
+/* Setup and reset all the emulated hardware: memory, CPU, TIA etc ... then
+ * load the cartridge and reset the CPU so emulation is ready to start.
+ */
+void atari2600_init(atari2600_t *atari, const uint8_t *cart)
+{
+    void (*line_handler)(atari2600_t *atari) = atari->line_handler;
+    void *user_data = atari->user_data;
+
+    memset(atari, 0, sizeof(*atari));
+    atari->line_handler = line_handler;
+    atari->user_data = user_data;
+
+    mos6532_init(&atari->riot);
+    TIA_init(&atari->tia);
+#if ATARI_TIA_PIPELINE
+    TIA_init(&atari->render_tia);
+    atari->tia.timing_only = 1;
+#endif
+    memmap_init(atari);
+
+    cartridge_load(atari, cart);
+    mos6507_reset(atari);
+
+    /* The CPU's cycles end on the third colour clock of each group of three
+     * along the line
+     */
+    atari->events[ATARI2600_EVENT_CPU] = ATARI2600_CPU_CLOCKS - 1;
+    atari->events[ATARI2600_EVENT_LINE] = TIA_COLOUR_CLOCK_TOTAL;
+
+#if MOS6507_CORE_INSTRUCTION
+    memmap_set_sync_handler(atari, atari2600_sync);
+#endif
+}
+
+/* Reports the joystick directions (as SWCHA reads them), the console
+ * switches (as SWCHB reads them) and the fire button (as TIA_joy1_state()
+ * takes it). They take effect from the CPU's next step, so this is safe to
+ * call from a different thread to the one running atari2600_step().
+ */
+void atari2600_set_inputs(atari2600_t *atari, uint8_t joystick, uint8_t switches, uint8_t fire)
+{
+    uint32_t inputs = ATARI2600_INPUTS_SET | (fire ? 0x10000 : 0) | (switches << 8) | joystick;
+    atomic_store_explicit(&atari->inputs, inputs, memory_order_relaxed);
+}
+
+/* Hands any change in the inputs to the RIOT and TIA. The packed word is
+ * all that's shared, so a relaxed load is enough, and every target can do
+ * one atomically.
+ */
+static inline void atari2600_apply_inputs(atari2600_t *atari)
+{
+    uint32_t inputs = atomic_load_explicit(&atari->inputs, memory_order_relaxed);
+
+    if (inputs == atari->inputs_applied) {
+        return;
+    }
+    atari->inputs_applied = inputs;
+    mos6532_write(&atari->riot, SWCHA, inputs & 0xFF);
+    mos6532_write(&atari->riot, SWCHB, (inputs >> 8) & 0xFF);
+    TIA_joy1_state(&atari->tia, (inputs >> 16) & 1);
+}
+
+/* Advances the console by one CPU instruction, by a single CPU cycle when
+ * the per-cycle core is built or by a slice of ATARI2600_SLICE_CYCLES when
+ * the threaded one is.
+ *
+ * Returns 0 on success, -1 if the CPU stopped on an illegal op-code.
+ */
+int atari2600_step(atari2600_t *atari)
+{
+    atari2600_apply_inputs(atari);
+
+#if MOS6507_CORE_THREADED
+    if (atari2600_idle(atari)) {
+        return 0;
+    }
+    return (mos6507_run_threaded(atari, ATARI2600_SLICE_CYCLES) < 0) ? -1 : 0;
+#elif MOS6507_CORE_INSTRUCTION
+    int cycles;
+
+    if (atari2600_idle(atari)) {
+        return 0;
+    }
+
+    atari->cycles_synced = 0;
+    cycles = mos6507_execute_instruction(atari);
+    if (cycles < 0) {
+        return -1;
+    }
+    atari2600_sync(atari, cycles - 1);
+#else
+    atari2600_cpu_cycle(atari);
+    if (!TIA_get_WSYNC(&atari->tia)) {
+        mos6532_clock_tick(&atari->riot);
+        if (mos6507_clock_tick(atari)) {
+            return -1;
+        }
+    }
+#endif
+    return 0;
+}
+
+/* Reads a TIA register for the CPU. Collisions depend on the picture so,
+ * when the TIA is pipelined, have to wait for the render side to catch up.
+ */
+void atari2600_tia_read(atari2600_t *atari, uint8_t reg, uint8_t *value)
+{
+#if ATARI_TIA_PIPELINE
+    if (reg <= TIA_READ_REG_CXPPMM) {
+        *value = TIA_log_read(&atari->tia_log, atari->clock, reg);
+        return;
+    }
+#endif
+    TIA_read_register(&atari->tia, reg, value);
+}
+
+/* Writes a TIA register for the CPU */
+void atari2600_tia_write(atari2600_t *atari, uint8_t reg, uint8_t value)
+{
+    TIA_write_register(&atari->tia, reg, value);
+#if ATARI_TIA_PIPELINE
+    TIA_log_push(&atari->tia_log, atari->clock, reg, value);
+#endif
+
+    if (reg == TIA_WRITE_REG_WSYNC) {
+        atari2600_wsync(atari);
+    }
+
+    /* Moving the start of the line moves its end, and the CPU's cycles are
+     * kept on the same colour clocks along the line
+     */
+    if (reg == TIA_WRITE_REG_RSYNC) {
+        uint32_t colour_clock = atari->tia.colour_clock;
+
+        atari->events[ATARI2600_EVENT_LINE] = atari->clock + TIA_line_remaining(&atari->tia);
+        atari->events[ATARI2600_EVENT_CPU] = atari->clock + ATARI2600_CPU_CLOCKS - ((colour_clock + 1) % ATARI2600_CPU_CLOCKS);
+    }
+}
+
+#if ATARI_TIA_PIPELINE
+/* Replays the logged TIA activity into render_tia, calling the line handler
+ * as each scanline is drawn. Meant to run on a different core or thread to
+ * atari2600_step().
+ *
+ * Returns the number of scanlines drawn, which stops at lines or when the
+ * log runs dry. While the CPU is waiting on a register read it carries on
+ * past lines until the read is answered, so the CPU isn't left stalled
+ * behind a backlog drawn a line per call.
+ */
+int atari2600_render(atari2600_t *atari, int lines)
+{
+    tia_log_entry_t entry;
+    int drawn = 0;
+
+    while ((drawn < lines || TIA_log_read_pending(&atari->tia_log)) &&
+           TIA_log_peek(&atari->tia_log, &entry)) {
+        while (atari->render_clock != entry.clock) {
+            uint32_t clocks = entry.clock - atari->render_clock;
+            uint32_t line = TIA_line_remaining(&atari->render_tia);
+
+            if (clocks > line) {
+                clocks = line;
+            }
+            atari->render_clock += clocks;
+            if (TIA_run(&atari->render_tia, clocks) >= TIA_COLOUR_CLOCK_TOTAL) {
+                if (atari->line_handler) {
+                    atari->line_handler(atari);
+                }
+                drawn++;
+            }
+        }
+
+        if (entry.kind == TIA_LOG_READ) {
+            uint8_t value = 0;
+            TIA_read_register(&atari->render_tia, entry.value, &value);
+            TIA_log_answer(&atari->tia_log, value);
+        } else if (entry.kind < TIA_LOG_LINE) {
+            TIA_write_register(&atari->render_tia, entry.kind, entry.value);
+        }
+        TIA_log_pop(&atari->tia_log);
+    }
+    return drawn;
+}
+#endif
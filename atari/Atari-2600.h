@@ -0,0 +1,105 @@
+/*
+ * File: Atari-2600.h
+ *
+ * Gathers the state of every chip in the console into a single context.
+ * Nothing in the emulation core is held in globals, so several consoles can
+ * be run side by side, each on its own thread.
+ */
+
+#ifndef _ATARI_2600_H
+#define _ATARI_2600_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "../mos6507/mos6507.h"
+#include "../mos6507/mos6507-interpreter.h"
+#include "../mos6532/mos6532.h"
+#include "Atari-TIA.h"
+#include "Atari-TIA-log.h"
+#include "Atari-memmap.h"
+
+typedef struct atari2600 atari2600_t;
+
+/* Things which happen at known times on the master clock. Each chip is run
+ * up to the next of these rather than stepped alongside the others.
+ */
+typedef enum {
+    ATARI2600_EVENT_CPU = 0, /* The CPU's next cycle */
+    ATARI2600_EVENT_LINE,    /* The TIA completes a scanline */
+    ATARI2600_EVENT_COUNT
+} atari2600_event_t;
+
+/* There are three colour clocks to each CPU cycle */
+#define ATARI2600_CPU_CLOCKS 3
+
+/* The threaded core runs about a scanline's worth of cycles at a time */
+#define ATARI2600_SLICE_CYCLES 76
+
+/* Marks the inputs as having been reported at least once */
+#define ATARI2600_INPUTS_SET 0x1000000
+
+struct atari2600 {
+    mos6507 cpu;
+    atari_tia tia;
+    mos6532 riot;
+    const uint8_t *cartridge;
+    /* Master clock, counted in colour clocks since reset, and the time each
+     * event is next due
+     */
+    uint64_t clock;
+    uint64_t events[ATARI2600_EVENT_COUNT];
+    memmap_page_t pages[MEMMAP_PAGE_COUNT];
+    /* Bus access timing for instruction-level execution */
+    memmap_sync_handler_t sync_handler;
+    uint8_t bus_cycle;
+    uint8_t cycles_synced;
+#if MOS6507_CORE_INSTRUCTION
+    mos6507_decoded_t decode_cache[MOS6507_DECODE_CACHE_SIZE];
+#endif
+    /* Called each time the TIA completes a scanline, user_data is left for
+     * the front end to find its own per-console state
+     */
+    void (*line_handler)(atari2600_t *atari);
+    void *user_data;
+    /* The controls as last reported by the front end, packed by
+     * atari2600_set_inputs(), and the last of those the CPU has seen
+     */
+    _Atomic uint32_t inputs;
+    uint32_t inputs_applied;
+#if ATARI_TIA_PIPELINE
+    /* The TIA above only keeps time for the CPU. Its register writes are
+     * logged with the colour clock they happen on, for render_tia to replay
+     * in atari2600_render() on another core and produce the picture.
+     */
+    tia_log_t tia_log;
+    atari_tia render_tia;
+    uint32_t render_clock;
+#endif
+};
+
+/* The TIA whose line buffer and registers match what's been drawn, for
+ * use from the line handler
+ */
+static inline atari_tia *atari2600_video(atari2600_t *atari)
+{
+#if ATARI_TIA_PIPELINE
+    return &atari->render_tia;
+#else
+    return &atari->tia;
+#endif
+}
+
+void atari2600_init(atari2600_t *atari, const uint8_t *cart);
+int atari2600_step(atari2600_t *atari);
+void atari2600_set_inputs(atari2600_t *atari, uint8_t joystick, uint8_t switches, uint8_t fire);
+void atari2600_tia_read(atari2600_t *atari, uint8_t reg, uint8_t *value);
+void atari2600_tia_write(atari2600_t *atari, uint8_t reg, uint8_t value);
+#if MOS6507_CORE_INSTRUCTION
+void atari2600_sync(atari2600_t *atari, uint8_t cycle);
+#endif
+#if ATARI_TIA_PIPELINE
+int atari2600_render(atari2600_t *atari, int lines);
+#endif
+
+#endif /* _ATARI_2600_H */
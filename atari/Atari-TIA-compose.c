@@ -0,0 +1,208 @@
+/*
+ * File: Atari-TIA-compose.c
+ *
+ * Builds host line buffer pixels from the object line masks and resolved
+ * pixel table. Pixels are composed in blocks by expanding a run of mask
+ * bits from each object into bytes, combining them into colour table
+ * indices and then looking up the pixel for each.
+ */
+
+#include "Atari-TIA-compose.h"
+
+#if !PICO_ON_DEVICE
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define TIA_COMPOSE_AVX2 1
+#endif
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#define TIA_COMPOSE_OBJECTS 6
+
+/* Copies a byte into each byte of a 64-bit word */
+#define TIA_BYTE_BROADCAST(b) ((uint64_t)((b) & 0xFF) * 0x0101010101010101ULL)
+
+/* Bit n set in byte n, for picking out the bit of a broadcast byte which
+ * belongs to each pixel
+ */
+#define TIA_BIT_SELECT 0x8040201008040201ULL
+
+typedef void (*tia_compose_fp)(atari_tia *tia, uint32_t x, uint32_t end, const uint32_t *table);
+
+static const uint8_t tia_compose_objects[TIA_COMPOSE_OBJECTS] = {
+    TIA_OBJECT_P0, TIA_OBJECT_M0, TIA_OBJECT_P1, TIA_OBJECT_M1, TIA_OBJECT_BL, TIA_OBJECT_PF
+};
+
+/* Retrieves up to 32 pixels of a mask starting at pixel x */
+static inline uint32_t TIA_mask_bits(const tia_mask_t *mask, uint32_t x)
+{
+    uint32_t word = x >> 6;
+    uint32_t shift = x & 63;
+    uint64_t bits = mask->word[word] >> shift;
+
+    if (shift > 32 && word + 1 < TIA_MASK_WORDS) {
+        bits |= mask->word[word + 1] << (64 - shift);
+    }
+    return (uint32_t)bits;
+}
+
+/* Retrieves the pixels of every object starting at pixel x, in the order
+ * of tia_compose_objects
+ */
+static inline void TIA_compose_bits(const atari_tia *tia, uint32_t x, uint32_t bits[TIA_COMPOSE_OBJECTS])
+{
+    bits[0] = TIA_mask_bits(&tia->players[0].line_mask, x);
+    bits[1] = TIA_mask_bits(&tia->missiles[0].line_mask, x);
+    bits[2] = TIA_mask_bits(&tia->players[1].line_mask, x);
+    bits[3] = TIA_mask_bits(&tia->missiles[1].line_mask, x);
+    bits[4] = TIA_mask_bits(&tia->ball.line_mask, x);
+    bits[5] = TIA_mask_bits(&tia->playfield.line_mask, x);
+}
+
+static void TIA_compose_scalar(atari_tia *tia, uint32_t x, uint32_t end, const uint32_t *table)
+{
+    uint32_t bits[TIA_COMPOSE_OBJECTS];
+
+    for (; x < end; x++) {
+        uint8_t objects = 0;
+
+        TIA_compose_bits(tia, x, bits);
+        for (int i = 0; i < TIA_COMPOSE_OBJECTS; i++) {
+            objects |= (bits[i] & 1) ? tia_compose_objects[i] : 0;
+        }
+        tia->line_buffer[x] = table[objects];
+    }
+}
+
+#if defined(__SSE2__)
+/* 16 pixels at a time */
+static void TIA_compose_sse2(atari_tia *tia, uint32_t x, uint32_t end, const uint32_t *table)
+{
+    const __m128i select = _mm_set1_epi64x((long long)TIA_BIT_SELECT);
+    uint32_t bits[TIA_COMPOSE_OBJECTS];
+    uint8_t objects[16];
+
+    for (; x + 16 <= end; x += 16) {
+        __m128i index = _mm_setzero_si128();
+
+        TIA_compose_bits(tia, x, bits);
+        for (int i = 0; i < TIA_COMPOSE_OBJECTS; i++) {
+            __m128i pixels = _mm_set_epi64x((long long)TIA_BYTE_BROADCAST(bits[i] >> 8),
+                                            (long long)TIA_BYTE_BROADCAST(bits[i]));
+            pixels = _mm_cmpeq_epi8(_mm_and_si128(pixels, select), select);
+            index = _mm_or_si128(index, _mm_and_si128(pixels, _mm_set1_epi8(tia_compose_objects[i])));
+        }
+        _mm_storeu_si128((__m128i *)objects, index);
+
+        for (int i = 0; i < 16; i++) {
+            tia->line_buffer[x + i] = table[objects[i]];
+        }
+    }
+    TIA_compose_scalar(tia, x, end, table);
+}
+#endif
+
+#if TIA_COMPOSE_AVX2
+/* 32 pixels at a time, looking the pixels up eight at once */
+__attribute__((target("avx2")))
+static void TIA_compose_avx2(atari_tia *tia, uint32_t x, uint32_t end, const uint32_t *table)
+{
+    const __m256i select = _mm256_set1_epi64x((long long)TIA_BIT_SELECT);
+    uint32_t bits[TIA_COMPOSE_OBJECTS];
+    uint8_t objects[32];
+
+    for (; x + 32 <= end; x += 32) {
+        __m256i index = _mm256_setzero_si256();
+
+        TIA_compose_bits(tia, x, bits);
+        for (int i = 0; i < TIA_COMPOSE_OBJECTS; i++) {
+            __m256i pixels = _mm256_set_epi64x((long long)TIA_BYTE_BROADCAST(bits[i] >> 24),
+                                               (long long)TIA_BYTE_BROADCAST(bits[i] >> 16),
+                                               (long long)TIA_BYTE_BROADCAST(bits[i] >> 8),
+                                               (long long)TIA_BYTE_BROADCAST(bits[i]));
+            pixels = _mm256_cmpeq_epi8(_mm256_and_si256(pixels, select), select);
+            index = _mm256_or_si256(index, _mm256_and_si256(pixels, _mm256_set1_epi8(tia_compose_objects[i])));
+        }
+        _mm256_storeu_si256((__m256i *)objects, index);
+
+        for (int i = 0; i < 32; i += 8) {
+            __m256i lookup = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)&objects[i]));
+            __m256i pixels = _mm256_i32gather_epi32((const int *)table, lookup, sizeof(uint32_t));
+            _mm256_storeu_si256((__m256i *)&tia->line_buffer[x + i], pixels);
+        }
+    }
+    TIA_compose_sse2(tia, x, end, table);
+}
+#endif
+
+#if !defined(__SSE2__) && defined(__ARM_NEON)
+/* 16 pixels at a time */
+static void TIA_compose_neon(atari_tia *tia, uint32_t x, uint32_t end, const uint32_t *table)
+{
+    const uint8x16_t select = vreinterpretq_u8_u64(vdupq_n_u64(TIA_BIT_SELECT));
+    uint32_t bits[TIA_COMPOSE_OBJECTS];
+    uint8_t objects[16];
+
+    for (; x + 16 <= end; x += 16) {
+        uint8x16_t index = vdupq_n_u8(0);
+
+        TIA_compose_bits(tia, x, bits);
+        for (int i = 0; i < TIA_COMPOSE_OBJECTS; i++) {
+            uint8x16_t pixels = vreinterpretq_u8_u64(vcombine_u64(vcreate_u64(TIA_BYTE_BROADCAST(bits[i])),
+                                                                  vcreate_u64(TIA_BYTE_BROADCAST(bits[i] >> 8))));
+            pixels = vtstq_u8(pixels, select);
+            index = vorrq_u8(index, vandq_u8(pixels, vdupq_n_u8(tia_compose_objects[i])));
+        }
+        vst1q_u8(objects, index);
+
+        for (int i = 0; i < 16; i++) {
+            tia->line_buffer[x + i] = table[objects[i]];
+        }
+    }
+    TIA_compose_scalar(tia, x, end, table);
+}
+#endif
+
+/* Default to the best the build guarantees until the CPU has been checked */
+#if defined(__SSE2__)
+static tia_compose_fp tia_compose = TIA_compose_sse2;
+#elif defined(__ARM_NEON)
+static tia_compose_fp tia_compose = TIA_compose_neon;
+#else
+static tia_compose_fp tia_compose = TIA_compose_scalar;
+#endif
+
+/* Picks the fastest compositor the CPU supports. The choice is shared by
+ * every console, so this is called once at start-up before any of them
+ * run rather than from TIA_init().
+ */
+void TIA_compose_init(void)
+{
+    #if TIA_COMPOSE_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        tia_compose = TIA_compose_avx2;
+    }
+    #endif
+}
+
+/* Composes pixels [start, end) of the line buffer. The colour table differs
+ * for each half of the line so spans are split where they cross the middle.
+ */
+void TIA_compose_span(atari_tia *tia, uint32_t start, uint32_t end)
+{
+    if (start < TIA_COLOUR_CLOCK_VISIBLE_HALF) {
+        uint32_t split = (end < TIA_COLOUR_CLOCK_VISIBLE_HALF) ? end : TIA_COLOUR_CLOCK_VISIBLE_HALF;
+        tia_compose(tia, start, split, tia->pixel_table[0]);
+        start = split;
+    }
+    if (start < end) {
+        tia_compose(tia, start, end, tia->pixel_table[1]);
+    }
+}
+
+#endif /* !PICO_ON_DEVICE */
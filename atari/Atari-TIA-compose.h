@@ -0,0 +1,22 @@
+/*
+ * File: Atari-TIA-compose.h
+ *
+ * Builds host line buffer pixels from the object line masks and resolved
+ * pixel table. Vectorised versions are picked at runtime to suit the CPU
+ * so headless runs aren't bound by the per-pixel work.
+ */
+
+#ifndef _ATARI_TIA_COMPOSE_H
+#define _ATARI_TIA_COMPOSE_H
+
+#include <stdint.h>
+#include "Atari-TIA.h"
+
+#if !PICO_ON_DEVICE
+
+void TIA_compose_init(void);
+void TIA_compose_span(atari_tia *tia, uint32_t start, uint32_t end);
+
+#endif /* !PICO_ON_DEVICE */
+
+#endif /* _ATARI_TIA_COMPOSE_H */
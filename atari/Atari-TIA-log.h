@@ -0,0 +1,109 @@
+/*
+ * File: Atari-TIA-log.h
+ *
+ * A single producer, single consumer queue of TIA register writes stamped
+ * with the colour clock they happened on. It lets the CPU run on one core
+ * while the TIA producing the picture replays its writes on the other.
+ */
+
+#ifndef _ATARI_TIA_LOG_H
+#define _ATARI_TIA_LOG_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+/* Must be a power of two */
+#define TIA_LOG_SIZE 1024
+
+/* Entries with a kind below TIA_LOG_LINE are writes to that register */
+#define TIA_LOG_LINE 0x40 /* A scanline completed */
+#define TIA_LOG_READ 0x41 /* Read a register and hand the value back */
+
+/* Clocks are the low bits of the master clock, which is plenty to keep the
+ * two sides in step
+ */
+typedef struct {
+    uint32_t clock;
+    uint8_t kind;
+    uint8_t value;
+} tia_log_entry_t;
+
+typedef struct {
+    tia_log_entry_t entries[TIA_LOG_SIZE];
+    _Atomic uint32_t head;  /* Only written by the producer */
+    _Atomic uint32_t tail;     /* Only written by the consumer */
+    _Atomic uint32_t requests; /* Count of TIA_LOG_READs queued */
+    _Atomic uint32_t reads;    /* Count of TIA_LOG_READs answered */
+    uint8_t read_value;
+} tia_log_t;
+
+/* Queues an entry, waiting for the consumer if the log is full */
+static inline void TIA_log_push(tia_log_t *log, uint32_t clock, uint8_t kind, uint8_t value)
+{
+    uint32_t head = atomic_load_explicit(&log->head, memory_order_relaxed);
+    tia_log_entry_t *entry = &log->entries[head & (TIA_LOG_SIZE - 1)];
+
+    while (head - atomic_load_explicit(&log->tail, memory_order_acquire) >= TIA_LOG_SIZE);
+
+    entry->clock = clock;
+    entry->kind = kind;
+    entry->value = value;
+    atomic_store_explicit(&log->head, head + 1, memory_order_release);
+}
+
+/* Retrieves the oldest entry without removing it.
+ *
+ * Returns 0 if the log is empty.
+ */
+static inline int TIA_log_peek(tia_log_t *log, tia_log_entry_t *entry)
+{
+    uint32_t tail = atomic_load_explicit(&log->tail, memory_order_relaxed);
+
+    if (tail == atomic_load_explicit(&log->head, memory_order_acquire)) {
+        return 0;
+    }
+    *entry = log->entries[tail & (TIA_LOG_SIZE - 1)];
+    return 1;
+}
+
+/* Removes the oldest entry, handing its slot back to the producer */
+static inline void TIA_log_pop(tia_log_t *log)
+{
+    uint32_t tail = atomic_load_explicit(&log->tail, memory_order_relaxed);
+    atomic_store_explicit(&log->tail, tail + 1, memory_order_release);
+}
+
+/* Reads a register through the consumer once it has caught up with the
+ * given clock. This is the only point the producer waits on the consumer
+ * other than when the log fills.
+ */
+static inline uint8_t TIA_log_read(tia_log_t *log, uint32_t clock, uint8_t reg)
+{
+    uint32_t reads = atomic_load_explicit(&log->reads, memory_order_relaxed);
+    uint32_t requests = atomic_load_explicit(&log->requests, memory_order_relaxed);
+
+    atomic_store_explicit(&log->requests, requests + 1, memory_order_relaxed);
+    TIA_log_push(log, clock, TIA_LOG_READ, reg);
+    while (atomic_load_explicit(&log->reads, memory_order_acquire) == reads);
+    return log->read_value;
+}
+
+/* Whether the producer is waiting on a TIA_LOG_READ, so the consumer
+ * should work through the log up to it without stopping
+ */
+static inline int TIA_log_read_pending(tia_log_t *log)
+{
+    return atomic_load_explicit(&log->requests, memory_order_relaxed) !=
+           atomic_load_explicit(&log->reads, memory_order_relaxed);
+}
+
+/* Hands the value of a TIA_LOG_READ back to the producer */
+static inline void TIA_log_answer(tia_log_t *log, uint8_t value)
+{
+    uint32_t reads = atomic_load_explicit(&log->reads, memory_order_relaxed);
+
+    log->read_value = value;
+    atomic_store_explicit(&log->reads, reads + 1, memory_order_release);
+}
+
+#endif /* _ATARI_TIA_LOG_H */
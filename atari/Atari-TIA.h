@@ -10,9 +10,7 @@
 #define _ATARI_TIA_H
 
 #include <stdint.h>
-
-#define X4(a) (a | (a << 8) | (a << 16) | (a << 24))
-#define VGA_RGB_222(r, g, b) ((r << 4) | (g << 2) | b)
+#include "Atari-palette.h"
 
 /* Ref: Stella Programmer's Guide, Pg. 4 */
 #define TIA_COLOUR_CLOCK_VISIBLE    160
@@ -99,13 +97,22 @@ typedef enum {
     TIA_READ_REG_LEN
 } tia_readable_register_t;
 
+/* Each object's pixels across the visible part of the line are held as a
+ * bitmask, pixel x being bit (x % 64) of word (x / 64).
+ */
+#define TIA_MASK_WORDS ((TIA_COLOUR_CLOCK_VISIBLE + 63) / 64)
+
+typedef struct {
+    uint64_t word[TIA_MASK_WORDS];
+} tia_mask_t;
+
 typedef struct {
     uint8_t scanline_reset;
     uint8_t enabled;
     uint32_t position_clock;
     uint8_t width;
     int8_t horizontal_offset;
-    uint8_t line_buffer[TIA_COLOUR_CLOCK_VISIBLE];
+    tia_mask_t line_mask;
 } tia_missile_t;
 
 typedef struct {
@@ -115,13 +122,13 @@ typedef struct {
     uint8_t width;
     int8_t horizontal_offset;
     uint8_t vertical_delay;
-    uint8_t line_buffer[TIA_COLOUR_CLOCK_VISIBLE];
+    tia_mask_t line_mask;
 } tia_ball_t;
 
 typedef struct {
     uint8_t mirror_enable;
     uint8_t score_enabled;
-    uint8_t line_buffer[TIA_COLOUR_CLOCK_VISIBLE];
+    tia_mask_t line_mask;
 } tia_playfield_t;
 
 typedef struct {
@@ -130,92 +137,99 @@ typedef struct {
     int8_t horizontal_offset;
     uint8_t vertical_delay;
     uint8_t pattern;
-    uint8_t line_buffer[TIA_COLOUR_CLOCK_VISIBLE];
+    tia_mask_t line_mask;
 } tia_player_t;
 
+/* Which objects are present on a pixel, used to index the colour table */
+#define TIA_OBJECT_P0 0x01
+#define TIA_OBJECT_M0 0x02
+#define TIA_OBJECT_P1 0x04
+#define TIA_OBJECT_M1 0x08
+#define TIA_OBJECT_BL 0x10
+#define TIA_OBJECT_PF 0x20
+#define TIA_OBJECT_COMBINATIONS 64
+
 /* Define a structure type to represent the state of a TIA chip */
 typedef struct {
     // Data registers
     uint8_t write_regs[TIA_WRITE_REG_LEN];
     uint8_t read_regs[TIA_READ_REG_LEN];
     uint32_t colour_clock;
+    /* Pixels are only produced when something could change them: ahead of
+     * a register access and at the end of the line. Everything before this
+     * colour clock has been rendered.
+     */
+    uint32_t render_clock;
+    /* Set when this TIA only keeps time for the CPU, with the picture and
+     * collisions left to another which is fed the same register writes
+     */
+    uint8_t timing_only;
     tia_ball_t ball;
     tia_missile_t missiles[2];
     tia_player_t players[2];
     tia_playfield_t playfield;
+    /* Line buffer pixels are in this format, converted via palette */
+    tia_palette_format_t palette_format;
+    uint32_t palette[TIA_PALETTE_COLOURS];
+    /* The pixel for each combination of objects, with priorities and score
+     * mode applied. Indexed by the half of the line then the TIA_OBJECT_*
+     * bits, and rebuilt when the colours, CTRLPF or palette change.
+     */
+    uint32_t pixel_table[2][TIA_OBJECT_COMBINATIONS];
+    /* To allow for easier output to non-raster devices we'll build the image
+     * one line at a time into this buffer.
+     */
+    uint32_t line_buffer[TIA_COLOUR_CLOCK_VISIBLE];
 } atari_tia;
 
-typedef struct {
-    uint8_t R;
-    uint8_t G;
-    uint8_t B;
-    uint8_t A;
-} tia_pixel_t;
-
-extern tia_pixel_t tia_colour_map[128];
 extern uint16_t tia_player_size_map[8];
 
-/* This is the single instance of atari_tia type to represent
- * the TIA in this application */
-extern atari_tia tia;
-
-/* To allow for easier output to non-raster devices we'll build the image one
- * line at a time into this buffer.
- */
-#if PICO_ON_DEVICE
-extern uint32_t tia_raw_buffer[TIA_COLOUR_CLOCK_VISIBLE];
-#else
-extern tia_pixel_t tia_line_buffer[TIA_COLOUR_CLOCK_VISIBLE];
-#endif
-
 // Joystic 1
-void TIA_joy1_state(uint8_t state);
+void TIA_joy1_state(atari_tia *tia, uint8_t state);
 
 /* Interfacing functions */
-void TIA_init(void);
-void TIA_read_register(uint8_t reg, uint8_t *value);
-void TIA_write_register(uint8_t reg, uint8_t value);
+void TIA_init(atari_tia *tia);
+void TIA_set_palette_format(atari_tia *tia, tia_palette_format_t format);
+void TIA_read_register(atari_tia *tia, uint8_t reg, uint8_t *value);
+void TIA_write_register(atari_tia *tia, uint8_t reg, uint8_t value);
 
-int TIA_clock_tick(void);
-void TIA_generate_colour(void);
+int TIA_clock_tick(atari_tia *tia);
+int TIA_run(atari_tia *tia, uint32_t clocks);
+uint32_t TIA_line_remaining(atari_tia *tia);
+void TIA_catch_up(atari_tia *tia);
 
-int TIA_get_WSYNC(void);
-int TIA_get_VSYNC(void);
-int TIA_get_VBLANK(void);
+int TIA_get_WSYNC(atari_tia *tia);
+int TIA_get_VSYNC(atari_tia *tia);
+int TIA_get_VBLANK(atari_tia *tia);
 
-void TIA_reset_buffer();
-void TIA_reset_line_buffer(uint8_t line_buffer[]);
+void TIA_reset_buffer(atari_tia *tia);
 
 uint8_t TIA_reverse_byte(uint8_t byte);
 
 
-void TIA_apply_HMOVE();
+void TIA_apply_HMOVE(atari_tia *tia);
 
 // Playfield
-int TIA_test_playfield_bit();
-void TIA_update_playfield();
+void TIA_update_playfield(atari_tia *tia);
 
 // Player #x
-int TIA_test_player_bit(uint8_t player);
-void TIA_reset_player(uint8_t player);
-void TIA_update_player_buffer(uint8_t player);
+void TIA_reset_player(atari_tia *tia, uint8_t player);
+void TIA_update_player_buffer(atari_tia *tia, uint8_t player);
 void TIA_get_player_registers(uint8_t player, tia_writable_register_t *reflect,
         tia_writable_register_t *graphics, tia_writable_register_t *offset,
         tia_writable_register_t *vertical, tia_writable_register_t *size_reg);
-void TIA_update_player_HMOVE(uint8_t player);
+void TIA_update_player_HMOVE(atari_tia *tia, uint8_t player);
 
 // Missile #x
-int TIA_test_missile_bit(uint8_t missile);
-void TIA_reset_missile(uint8_t missile);
-void TIA_update_missile_buffer(uint8_t missile);
+void TIA_reset_missile(atari_tia *tia, uint8_t missile);
+void TIA_update_missile_buffer(atari_tia *tia, uint8_t missile);
 void TIA_get_missile_registers(uint8_t missile, tia_writable_register_t *enable,
         tia_writable_register_t *size, tia_writable_register_t *offset);
-void TIA_update_missile_HMOVE(uint8_t missile);
+void TIA_update_missile_HMOVE(atari_tia *tia, uint8_t missile);
 
 // Ball
-int TIA_test_ball_bit();
-void TIA_reset_ball();
-void TIA_update_ball_buffer();
-void TIA_update_ball_HMOVE();
+void TIA_reset_ball(atari_tia *tia);
+void TIA_update_ball_buffer(atari_tia *tia);
+void TIA_update_ball_HMOVE(atari_tia *tia);
 
 #endif /* _ATARI_TIA_H */
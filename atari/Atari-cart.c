@@ -6,32 +6,34 @@
  * Mimics ROM space (that is, a game cartridge).
  */
 
+#include "Atari-2600.h"
 #include "Atari-cart.h"
+#include "Atari-memmap.h"
 
 /* Cartridges are represented as arrays of bytes in their own
  * part of memory. We "load" a cartridge by storing a pointer 
- * to the desired cartridge data.
+ * to the desired cartridge data in the console.
  */
-static const uint8_t *cartridge = 0;
-
-void cartridge_read(uint16_t address, uint8_t * data)
+void cartridge_read(atari2600_t *atari, uint16_t address, uint8_t * data)
 {
-    if (cartridge) {
-        *data = cartridge[address];
+    if (atari->cartridge) {
+        *data = atari->cartridge[address];
     }
 }
 
-void cartridge_load(const uint8_t *cart)
+void cartridge_load(atari2600_t *atari, const uint8_t *cart)
 {
-    if (cartridge) {
-        cartridge_eject();
+    if (atari->cartridge) {
+        cartridge_eject(atari);
     }
-    cartridge = cart;
+    atari->cartridge = cart;
+    memmap_map_cartridge(atari);
 }
 
-void cartridge_eject(void)
+void cartridge_eject(atari2600_t *atari)
 {
     /* Clear the pointer to the current cartridge array */
-    cartridge = 0;
+    atari->cartridge = 0;
+    memmap_map_cartridge(atari);
 }
 
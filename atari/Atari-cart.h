@@ -11,8 +11,10 @@
 
 #include <stdint.h>
 
-void cartridge_read(uint16_t address, uint8_t * data);
-void cartridge_load(const uint8_t *cart);
-void cartridge_eject(void);
+typedef struct atari2600 atari2600_t;
+
+void cartridge_read(atari2600_t *atari, uint16_t address, uint8_t * data);
+void cartridge_load(atari2600_t *atari, const uint8_t *cart);
+void cartridge_eject(atari2600_t *atari);
 
 #endif /* _ATARI_CART_H */
@@ -9,18 +9,33 @@
 #include <stdio.h>
 
 
+#include "Atari-2600.h"
 #include "Atari-memmap.h"
 #include "Atari-cart.h"
 #include "Atari-TIA.h"
 #include "../mos6507/mos6507.h"
+#include "../mos6507/mos6507-interpreter.h"
 #include "../mos6532/mos6532.h"
 
-#define IS_TIA(x)  (x >= MEMMAP_TIA_START && x <= MEMMAP_TIA_END)
-#define IS_RIOT(x) ((x >= MEMMAP_RIOT_RAM_START && x <= MEMMAP_RIOT_RAM_END) || \
-                    (x >= MEMMAP_RIOT_RAM_MIRROR_START && x <= MEMMAP_RIOT_RAM_MIRROR_END) || \
-                    (x >= MEMMAP_RIOT_PERIPH_START && x <= MEMMAP_RIOT_PERIPH_END) || \
-                    (x >= MEMMAP_RIOT_PERIPH_MIRROR_START && x <= MEMMAP_RIOT_PERIPH_MIRROR_END))
-#define IS_CART(x) (x >= MEMMAP_CART_START && x <= MEMMAP_CART_END)
+void memmap_set_sync_handler(atari2600_t *atari, memmap_sync_handler_t handler)
+{
+    atari->sync_handler = handler;
+}
+
+void memmap_set_bus_cycle(atari2600_t *atari, uint8_t cycle)
+{
+    atari->bus_cycle = cycle;
+}
+
+/* Brings the TIA and RIOT up to the cycle of the pending access. Per-cycle
+ * execution keeps them in lockstep already and registers no handler.
+ */
+static inline void memmap_sync(atari2600_t *atari)
+{
+    if (atari->sync_handler) {
+        atari->sync_handler(atari, atari->bus_cycle);
+    }
+}
 
 void memmap_map_address(uint16_t *address)
 {
@@ -34,59 +49,119 @@ void memmap_map_address(uint16_t *address)
     *address = (*address & 0x1FFF);
 }
 
-/* These read/write functions essentially replicate the 
- * chip-select pins on the TIA and RIOT by delegating 
- * memory access requests to their respective locations.
+static void memmap_read_tia(atari2600_t *atari, uint16_t address, uint8_t *data)
+{
+    atari2600_tia_read(atari, address & MEMMAP_TIA_READ_MASK, data);
+}
+
+static void memmap_write_tia(atari2600_t *atari, uint16_t address, uint8_t data)
+{
+    atari2600_tia_write(atari, address & MEMMAP_TIA_WRITE_MASK, data);
+}
+
+static void memmap_read_riot(atari2600_t *atari, uint16_t address, uint8_t *data)
+{
+    mos6532_read(&atari->riot, address, data);
+}
+
+static void memmap_write_riot(atari2600_t *atari, uint16_t address, uint8_t data)
+{
+    mos6532_write(&atari->riot, address, data);
+}
+
+/* Fills in the page table. These essentially replicate the chip-select
+ * pins on the TIA and RIOT: A12 selects the cartridge, otherwise A7 picks
+ * the RIOT over the TIA and A9 the RIOT's I/O and timer over its RAM. The
+ * remaining address lines are ignored, giving the full set of mirrors.
  */
-void memmap_write(void)
+void memmap_init(atari2600_t *atari)
 {
-    /* Fetch data and address from CPU */
-    uint16_t address;
-    uint8_t data;
-    mos6507_get_data_bus(&data);
-    mos6507_get_address_bus(&address);
-    memmap_map_address(&address);
-
-    /* Access particular device */
-    if (IS_TIA(address)) TIA_write_register(address - MEMMAP_TIA_START, data);
-    if (IS_RIOT(address)) {
-        memmap_map_riot_address(&address);
-        mos6532_write(address, data);
+    int page;
+
+    for (page = 0; page < MEMMAP_PAGE_COUNT; page++) {
+        uint16_t address = page << MEMMAP_PAGE_SHIFT;
+        memmap_page_t *entry = &atari->pages[page];
+
+        *entry = (memmap_page_t){0};
+        if (address & MEMMAP_SELECT_CART) {
+            continue;
+        }
+        if (!(address & MEMMAP_SELECT_RIOT)) {
+            entry->read_handler = memmap_read_tia;
+            entry->write_handler = memmap_write_tia;
+        } else if (address & MEMMAP_SELECT_RIOT_IO) {
+            entry->read_handler = memmap_read_riot;
+            entry->write_handler = memmap_write_riot;
+        } else {
+            entry->read = atari->riot.memory;
+            entry->write = atari->riot.memory;
+        }
     }
-    if (IS_CART(address)) {
-        /* Cartridges are read-only. Are there hardware peripherals which 
-         * use this space for extending functionality? E.g., SuperCharger?
-         */
+    memmap_map_cartridge(atari);
+}
+
+/* Points the cartridge pages at the loaded cartridge, or leaves them
+ * unmapped if there isn't one. Cartridges are read-only so writes are
+ * always dropped. Anything which changes what the cartridge pages map to
+ * (e.g. bank switching) must come through here so the instruction core
+ * re-decodes them.
+ */
+void memmap_map_cartridge(atari2600_t *atari)
+{
+    int page;
+
+    for (page = MEMMAP_CART_START >> MEMMAP_PAGE_SHIFT; page < MEMMAP_PAGE_COUNT; page++) {
+        atari->pages[page].read = 0;
+        if (atari->cartridge) {
+            atari->pages[page].read = atari->cartridge +
+                ((page << MEMMAP_PAGE_SHIFT) - MEMMAP_CART_START);
+        }
     }
+#if MOS6507_CORE_INSTRUCTION
+    mos6507_decode_cache_fill(atari);
+#endif
 }
 
-void memmap_read(uint8_t *data)
+void memmap_write(atari2600_t *atari)
 {
-    /* Fetch address from CPU */
+    /* Fetch data and address from CPU */
     uint16_t address;
-    mos6507_get_address_bus(&address);
-    memmap_map_address(&address);
-
-    /* Access particular device */
-    if (IS_TIA(address)) TIA_read_register(address - MEMMAP_TIA_START, data);
-    if (IS_RIOT(address)) {
-        memmap_map_riot_address(&address);
-        mos6532_read(address, data);
-    }
-    if (IS_CART(address)) cartridge_read(address - MEMMAP_CART_START, data);
+    uint8_t data;
+    const memmap_page_t *page;
+    mos6507_get_data_bus(&atari->cpu, &data);
+    mos6507_get_address_bus(&atari->cpu, &address);
+    address &= MEMMAP_ADDRESS_MASK;
 
-    mos6507_set_data_bus(*data);
+    page = &atari->pages[address >> MEMMAP_PAGE_SHIFT];
+    if (page->write) {
+        page->write[address & MEMMAP_PAGE_MASK] = data;
+#if MOS6507_CORE_INSTRUCTION
+        /* Writable cartridge memory may hold code which has been decoded */
+        if (address & MEMMAP_SELECT_CART) {
+            mos6507_decode_cache_invalidate(atari, address, 1);
+        }
+#endif
+    } else if (page->write_handler) {
+        memmap_sync(atari);
+        page->write_handler(atari, address, data);
+    }
 }
 
-void memmap_map_riot_address(uint16_t *address)
+void memmap_read(atari2600_t *atari, uint8_t *data)
 {
-    if (*address >= MEMMAP_RIOT_RAM_START && *address <= MEMMAP_RIOT_RAM_END) {
-        *address = *address - MEMMAP_RIOT_RAM_START;
-    }
-    if (*address >= MEMMAP_RIOT_RAM_MIRROR_START && *address <= MEMMAP_RIOT_RAM_MIRROR_END) {
-        *address = *address - MEMMAP_RIOT_RAM_MIRROR_START;
-    }
-    if (*address >= MEMMAP_RIOT_PERIPH_MIRROR_START && *address <= MEMMAP_RIOT_PERIPH_MIRROR_END) {
-        *address = *address - 0x100;
+    /* Fetch address from CPU */
+    uint16_t address;
+    const memmap_page_t *page;
+    mos6507_get_address_bus(&atari->cpu, &address);
+    address &= MEMMAP_ADDRESS_MASK;
+
+    page = &atari->pages[address >> MEMMAP_PAGE_SHIFT];
+    if (page->read) {
+        *data = page->read[address & MEMMAP_PAGE_MASK];
+    } else if (page->read_handler) {
+        memmap_sync(atari);
+        page->read_handler(atari, address, data);
     }
+
+    mos6507_set_data_bus(&atari->cpu, *data);
 }
@@ -24,9 +24,51 @@
 #define MEMMAP_CART_START               0x1000
 #define MEMMAP_CART_END                 0x1FFF
 
-void memmap_write(void);
-void memmap_read(uint8_t *data);
+/* The 13-bit address space is split into 128 byte pages, the smallest unit
+ * the TIA, RIOT and cartridge chip selects distinguish between. Each page
+ * either points straight at the memory behind it or hands the access to a
+ * device handler.
+ */
+#define MEMMAP_ADDRESS_MASK             0x1FFF
+#define MEMMAP_PAGE_SHIFT               7
+#define MEMMAP_PAGE_SIZE                (1 << MEMMAP_PAGE_SHIFT)
+#define MEMMAP_PAGE_MASK                (MEMMAP_PAGE_SIZE - 1)
+#define MEMMAP_PAGE_COUNT               ((MEMMAP_ADDRESS_MASK + 1) >> MEMMAP_PAGE_SHIFT)
+
+/* Address lines decoded by the chip selects */
+#define MEMMAP_SELECT_CART              0x1000 /* A12 */
+#define MEMMAP_SELECT_RIOT              0x0080 /* A7 */
+#define MEMMAP_SELECT_RIOT_IO           0x0200 /* A9 */
+#define MEMMAP_TIA_READ_MASK            0x000F
+#define MEMMAP_TIA_WRITE_MASK           0x003F
+
+/* Instruction-level execution stamps each bus access with the cycle of the
+ * current instruction it falls on. Accesses reaching the TIA or RIOT first
+ * pass that cycle to the sync handler so those chips can be caught up.
+ */
+typedef struct atari2600 atari2600_t;
+typedef void (*memmap_sync_handler_t)(atari2600_t *atari, uint8_t cycle);
+
+typedef void (*memmap_read_handler_t)(atari2600_t *atari, uint16_t address, uint8_t *data);
+typedef void (*memmap_write_handler_t)(atari2600_t *atari, uint16_t address, uint8_t data);
+
+/* Pages with a memory pointer are accessed directly, otherwise the handler
+ * is called. A page with neither leaves reads on the data bus unchanged and
+ * ignores writes.
+ */
+typedef struct {
+    const uint8_t *read;
+    uint8_t *write;
+    memmap_read_handler_t read_handler;
+    memmap_write_handler_t write_handler;
+} memmap_page_t;
+
+void memmap_init(atari2600_t *atari);
+void memmap_map_cartridge(atari2600_t *atari);
+void memmap_set_sync_handler(atari2600_t *atari, memmap_sync_handler_t handler);
+void memmap_set_bus_cycle(atari2600_t *atari, uint8_t cycle);
+void memmap_write(atari2600_t *atari);
+void memmap_read(atari2600_t *atari, uint8_t *data);
 void memmap_map_address(uint16_t *address);
-void memmap_map_riot_address(uint16_t *address);
 
 #endif /* _MEMMAP_H */
@@ -0,0 +1,177 @@
+/*
+ * File: Atari-palette.c
+ *
+ * Converts the TIA colours into the pixel formats of the supported video
+ * outputs, so rendering only has to copy ready made pixels.
+ */
+
+#include "Atari-palette.h"
+
+/* Usage note:
+ *
+ * This table is mapped to allow for lookup from a value in one of the colour
+ * registers. However, the colour reigsters don't use the least significant
+ * bit so the table locations assume the value has been shifted by one bit
+ * for easier alignment. See page 43 of docs/Stella Programmer's guide.pdf
+ *
+ * N.B: only the NTSC colour pallete is supported.
+ */
+tia_pixel_t tia_colour_map[TIA_PALETTE_COLOURS] = {
+    /* TIA:  >>1:  Index (dec): */
+    { 0x00, 0x00, 0x00, 0xFF }, /* 0x00, 0x00, 0 */
+    { 0x1A, 0x1A, 0x1A, 0xFF }, /* 0x02, 0x01, 1 */
+    { 0x39, 0x39, 0x39, 0xFF }, /* 0x04, 0x02, 2 */
+    { 0x58, 0x58, 0x58, 0xFF }, /* 0x06, 0x03, 3 */
+    { 0x7E, 0x7E, 0x7E, 0xFF }, /* 0x08, 0x04, 4 */
+    { 0xA2, 0xA2, 0xA2, 0xFF }, /* 0x0A, 0x05, 5 */
+    { 0xC7, 0xC7, 0xC7, 0xFF }, /* 0x0C, 0x06, 6 */
+    { 0xED, 0xED, 0xED, 0xFF }, /* 0x0E, 0x07, 7 */
+    { 0x19, 0x02, 0x00, 0xFF }, /* 0x10, 0x08, 8 */
+    { 0x3A, 0x1F, 0x00, 0xFF }, /* 0x12, 0x09, 9 */
+    { 0x5D, 0x41, 0x00, 0xFF }, /* 0x14, 0x0A, 10 */
+    { 0x82, 0x64, 0x00, 0xFF }, /* 0x16, 0x0B, 11 */
+    { 0xA7, 0x88, 0x00, 0xFF }, /* 0x18, 0x0C, 12 */
+    { 0xCC, 0xAD, 0x00, 0xFF }, /* 0x1A, 0x0D, 13 */
+    { 0xF2, 0xD2, 0x19, 0xFF }, /* 0x1C, 0x0E, 14 */
+    { 0xFE, 0xFA, 0x40, 0xFF }, /* 0x1E, 0x0F, 15 */
+    { 0x37, 0x00, 0x00, 0xFF }, /* 0x20, 0x10, 16 */
+    { 0x5E, 0x08, 0x00, 0xFF }, /* 0x22, 0x11, 17 */
+    { 0x83, 0x27, 0x00, 0xFF }, /* 0x24, 0x12, 18 */
+    { 0xA9, 0x49, 0x00, 0xFF }, /* 0x26, 0x13, 19 */
+    { 0xCF, 0x6C, 0x00, 0xFF }, /* 0x28, 0x14, 20 */
+    { 0xF5, 0x8F, 0x17, 0xFF }, /* 0x2A, 0x15, 21 */
+    { 0xFE, 0xB4, 0x38, 0xFF }, /* 0x2C, 0x16, 22 */
+    { 0xFE, 0xDF, 0x6F, 0xFF }, /* 0x2E, 0x17, 23 */
+    { 0x47, 0x00, 0x00, 0xFF }, /* 0x30, 0x18, 24 */
+    { 0x73, 0x00, 0x00, 0xFF }, /* 0x32, 0x19, 25 */
+    { 0x98, 0x13, 0x00, 0xFF }, /* 0x34, 0x1A, 26 */
+    { 0xBE, 0x32, 0x16, 0xFF }, /* 0x36, 0x1B, 27 */
+    { 0xE4, 0x53, 0x35, 0xFF }, /* 0x38, 0x1C, 28 */
+    { 0xFE, 0x76, 0x57, 0xFF }, /* 0x3A, 0x1D, 29 */
+    { 0xFE, 0x9C, 0x81, 0xFF }, /* 0x3C, 0x1E, 30 */
+    { 0xFE, 0xC6, 0xBB, 0xFF }, /* 0x3E, 0x1F, 31 */
+    { 0x44, 0x00, 0x08, 0xFF }, /* 0x40, 0x20, 32 */
+    { 0x6F, 0x00, 0x1F, 0xFF }, /* 0x42, 0x21, 33 */
+    { 0x96, 0x06, 0x40, 0xFF }, /* 0x44, 0x22, 34 */
+    { 0xBB, 0x24, 0x62, 0xFF }, /* 0x46, 0x23, 35 */
+    { 0xE1, 0x45, 0x85, 0xFF }, /* 0x48, 0x24, 36 */
+    { 0xFE, 0x67, 0xAA, 0xFF }, /* 0x4A, 0x25, 37 */
+    { 0xFE, 0x8C, 0xD6, 0xFF }, /* 0x4C, 0x26, 38 */
+    { 0xFE, 0xB7, 0xF6, 0xFF }, /* 0x4E, 0x27, 39 */
+    { 0x2D, 0x00, 0x4A, 0xFF }, /* 0x50, 0x28, 40 */
+    { 0x57, 0x00, 0x67, 0xFF }, /* 0x52, 0x29, 41 */
+    { 0x7D, 0x05, 0x8C, 0xFF }, /* 0x54, 0x2A, 42 */
+    { 0xA1, 0x22, 0xB1, 0xFF }, /* 0x56, 0x2B, 43 */
+    { 0xC7, 0x43, 0xD7, 0xFF }, /* 0x58, 0x2C, 44 */
+    { 0xED, 0x65, 0xFE, 0xFF }, /* 0x5A, 0x2D, 45 */
+    { 0xFE, 0x8A, 0xF6, 0xFF }, /* 0x5C, 0x2E, 46 */
+    { 0xFE, 0xB5, 0xF7, 0xFF }, /* 0x5E, 0x2F, 47 */
+    { 0x0D, 0x00, 0x82, 0xFF }, /* 0x60, 0x30, 48 */
+    { 0x33, 0x00, 0xA2, 0xFF }, /* 0x62, 0x31, 49 */
+    { 0x55, 0x0F, 0xC9, 0xFF }, /* 0x64, 0x32, 50 */
+    { 0x78, 0x2D, 0xF0, 0xFF }, /* 0x66, 0x33, 51 */
+    { 0x9C, 0x4E, 0xFE, 0xFF }, /* 0x68, 0x34, 52 */
+    { 0xC3, 0x72, 0xFE, 0xFF }, /* 0x6A, 0x35, 53 */
+    { 0xEB, 0x98, 0xFE, 0xFF }, /* 0x6C, 0x36, 54 */
+    { 0xFE, 0xC0, 0xF9, 0xFF }, /* 0x6E, 0x37, 55 */
+    { 0x00, 0x00, 0x91, 0xFF }, /* 0x70, 0x38, 56 */
+    { 0x0A, 0x05, 0xBD, 0xFF }, /* 0x72, 0x39, 57 */
+    { 0x28, 0x22, 0xE4, 0xFF }, /* 0x74, 0x3A, 58 */
+    { 0x48, 0x42, 0xFE, 0xFF }, /* 0x76, 0x3B, 59 */
+    { 0x6B, 0x64, 0xFE, 0xFF }, /* 0x78, 0x3C, 50 */
+    { 0x90, 0x8A, 0xFE, 0xFF }, /* 0x7A, 0x3D, 51 */
+    { 0xB7, 0xB0, 0xFE, 0xFF }, /* 0x7C, 0x3E, 52 */
+    { 0xDF, 0xD8, 0xFE, 0xFF }, /* 0x7E, 0x3F, 53 */
+    { 0x00, 0x00, 0x72, 0xFF }, /* 0x80, 0x40, 54 */
+    { 0x00, 0x1C, 0xAB, 0xFF }, /* 0x82, 0x41, 55 */
+    { 0x03, 0x3C, 0xD6, 0xFF }, /* 0x84, 0x42, 56 */
+    { 0x20, 0x5E, 0xFD, 0xFF }, /* 0x86, 0x43, 57 */
+    { 0x40, 0x81, 0xFE, 0xFF }, /* 0x88, 0x44, 58 */
+    { 0x64, 0xA6, 0xFE, 0xFF }, /* 0x8A, 0x45, 59 */
+    { 0x89, 0xCE, 0xFE, 0xFF }, /* 0x8C, 0x46, 60 */
+    { 0xB0, 0xF6, 0xFE, 0xFF }, /* 0x8E, 0x47, 61 */
+    { 0x00, 0x10, 0x3A, 0xFF }, /* 0x90, 0x48, 62 */
+    { 0x00, 0x31, 0x6E, 0xFF }, /* 0x92, 0x49, 63 */
+    { 0x00, 0x55, 0xA2, 0xFF }, /* 0x94, 0x4A, 64 */
+    { 0x05, 0x79, 0xC8, 0xFF }, /* 0x96, 0x4B, 65 */
+    { 0x23, 0x9D, 0xEE, 0xFF }, /* 0x98, 0x4C, 66 */
+    { 0x44, 0xC2, 0xFE, 0xFF }, /* 0x9A, 0x4D, 67 */
+    { 0x68, 0xE9, 0xFE, 0xFF }, /* 0x9C, 0x4E, 68 */
+    { 0x8F, 0xFE, 0xFE, 0xFF }, /* 0x9E, 0x4F, 69 */
+    { 0x00, 0x1F, 0x02, 0xFF }, /* 0xA0, 0x50, 70 */
+    { 0x00, 0x43, 0x26, 0xFF }, /* 0xA2, 0x51, 71 */
+    { 0x00, 0x69, 0x57, 0xFF }, /* 0xA4, 0x52, 72 */
+    { 0x00, 0x8D, 0x7A, 0xFF }, /* 0xA6, 0x53, 73 */
+    { 0x1B, 0xB1, 0x9E, 0xFF }, /* 0xA8, 0x54, 74 */
+    { 0x3B, 0xD7, 0xC3, 0xFF }, /* 0xAA, 0x55, 75 */
+    { 0x5D, 0xFE, 0xE9, 0xFF }, /* 0xAC, 0x56, 76 */
+    { 0x86, 0xFE, 0xFE, 0xFF }, /* 0xAE, 0x57, 77 */
+    { 0x00, 0x24, 0x03, 0xFF }, /* 0xB0, 0x58, 78 */
+    { 0x00, 0x4A, 0x05, 0xFF }, /* 0xB2, 0x59, 79 */
+    { 0x00, 0x70, 0x0C, 0xFF }, /* 0xB4, 0x5A, 80 */
+    { 0x09, 0x95, 0x2B, 0xFF }, /* 0xB6, 0x5B, 81 */
+    { 0x28, 0xBA, 0x4C, 0xFF }, /* 0xB8, 0x5C, 82 */
+    { 0x49, 0xE0, 0x6E, 0xFF }, /* 0xBA, 0x5D, 83 */
+    { 0x6C, 0xFE, 0x92, 0xFF }, /* 0xBC, 0x5E, 84 */
+    { 0x97, 0xFE, 0xB5, 0xFF }, /* 0xBE, 0x5F, 85 */
+    { 0x00, 0x21, 0x02, 0xFF }, /* 0xC0, 0x60, 86 */
+    { 0x00, 0x46, 0x04, 0xFF }, /* 0xC2, 0x61, 87 */
+    { 0x08, 0x6B, 0x00, 0xFF }, /* 0xC4, 0x62, 88 */
+    { 0x28, 0x90, 0x00, 0xFF }, /* 0xC6, 0x63, 89 */
+    { 0x49, 0xB5, 0x09, 0xFF }, /* 0xC8, 0x64, 90 */
+    { 0x6B, 0xDB, 0x28, 0xFF }, /* 0xCA, 0x65, 91 */
+    { 0x8F, 0xFE, 0x49, 0xFF }, /* 0xCC, 0x66, 92 */
+    { 0xBB, 0xFE, 0x69, 0xFF }, /* 0xCE, 0x67, 93 */
+    { 0x00, 0x15, 0x01, 0xFF }, /* 0xD0, 0x68, 94 */
+    { 0x10, 0x36, 0x00, 0xFF }, /* 0xD2, 0x69, 95 */
+    { 0x30, 0x59, 0x00, 0xFF }, /* 0xD4, 0x6A, 96 */
+    { 0x53, 0x7E, 0x00, 0xFF }, /* 0xD6, 0x6B, 97 */
+    { 0x76, 0xA3, 0x00, 0xFF }, /* 0xD8, 0x6C, 98 */
+    { 0x9A, 0xC8, 0x00, 0xFF }, /* 0xDA, 0x6D, 99 */
+    { 0xBF, 0xEE, 0x1E, 0xFF }, /* 0xDC, 0x6E, 100 */
+    { 0xE8, 0xFE, 0x3E, 0xFF }, /* 0xDE, 0x6F, 101 */
+    { 0x1A, 0x02, 0x00, 0xFF }, /* 0xE0, 0x70, 102 */
+    { 0x3B, 0x1F, 0x00, 0xFF }, /* 0xE2, 0x71, 103 */
+    { 0x5E, 0x41, 0x00, 0xFF }, /* 0xE4, 0x72, 104 */
+    { 0x83, 0x64, 0x00, 0xFF }, /* 0xE6, 0x73, 105 */
+    { 0xA8, 0x88, 0x00, 0xFF }, /* 0xE8, 0x74, 106 */
+    { 0xCE, 0xAD, 0x00, 0xFF }, /* 0xEA, 0x75, 107 */
+    { 0xF4, 0xD2, 0x18, 0xFF }, /* 0xEC, 0x76, 108 */
+    { 0xFE, 0xFA, 0x40, 0xFF }, /* 0xEE, 0x77, 109 */
+    { 0x38, 0x00, 0x00, 0xFF }, /* 0xF0, 0x78, 110 */
+    { 0x5F, 0x08, 0x00, 0xFF }, /* 0xF2, 0x79, 111 */
+    { 0x84, 0x27, 0x00, 0xFF }, /* 0xF4, 0x7A, 112 */
+    { 0xAA, 0x49, 0x00, 0xFF }, /* 0xF6, 0x7B, 113 */
+    { 0xD0, 0x6B, 0x00, 0xFF }, /* 0xF8, 0x7C, 114 */
+    { 0xF6, 0x8F, 0x18, 0xFF }, /* 0xFA, 0x7D, 115 */
+    { 0xFE, 0xB4, 0x39, 0xFF }, /* 0xFC, 0x7E, 116 */
+    { 0xFE, 0xDF, 0x70, 0xFF}  /* 0xFE, 0x7F, 117 */
+};
+
+/* Converts a palette colour into a pixel of the given format */
+static uint32_t TIA_palette_pixel(tia_palette_format_t format, uint8_t index)
+{
+    const tia_pixel_t *colour = &tia_colour_map[index];
+
+    switch (format) {
+        case TIA_PALETTE_RGB222_X4:
+            return X4(VGA_RGB_222((uint32_t)colour->R >> 6, (uint32_t)colour->G >> 6, (uint32_t)colour->B >> 6));
+        case TIA_PALETTE_RGB565:
+            return ((colour->R >> 3) << 11) | ((colour->G >> 2) << 5) | (colour->B >> 3);
+        case TIA_PALETTE_XRGB8888:
+            return ((uint32_t)colour->R << 16) | ((uint32_t)colour->G << 8) | colour->B;
+        case TIA_PALETTE_INDEX:
+        default:
+            return index;
+    }
+}
+
+/* Fills palette with a pixel for every colour, indexed by the colour
+ * register value shifted down by one
+ */
+void TIA_palette_build(tia_palette_format_t format, uint32_t palette[TIA_PALETTE_COLOURS])
+{
+    for (int i = 0; i < TIA_PALETTE_COLOURS; i++) {
+        palette[i] = TIA_palette_pixel(format, i);
+    }
+}
@@ -0,0 +1,38 @@
+/*
+ * File: Atari-palette.h
+ *
+ * Converts the TIA colours into the pixel formats of the supported video
+ * outputs, so rendering only has to copy ready made pixels.
+ */
+
+#ifndef _ATARI_PALETTE_H
+#define _ATARI_PALETTE_H
+
+#include <stdint.h>
+
+#define X4(a) (a | (a << 8) | (a << 16) | (a << 24))
+#define VGA_RGB_222(r, g, b) ((r << 4) | (g << 2) | b)
+
+/* Colour registers ignore their least significant bit */
+#define TIA_PALETTE_COLOURS 128
+
+typedef struct {
+    uint8_t R;
+    uint8_t G;
+    uint8_t B;
+    uint8_t A;
+} tia_pixel_t;
+
+/* Every format fits a pixel in 32 bits, narrower ones in the low bits */
+typedef enum {
+    TIA_PALETTE_RGB222_X4 = 0, /* VGA 222, repeated in each byte */
+    TIA_PALETTE_RGB565,
+    TIA_PALETTE_XRGB8888,
+    TIA_PALETTE_INDEX          /* Index into tia_colour_map */
+} tia_palette_format_t;
+
+extern tia_pixel_t tia_colour_map[TIA_PALETTE_COLOURS];
+
+void TIA_palette_build(tia_palette_format_t format, uint32_t palette[TIA_PALETTE_COLOURS]);
+
+#endif /* _ATARI_PALETTE_H */
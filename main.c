@@ -3,6 +3,7 @@
 /* Standard library includes */
 #include <stdio.h>
 #include <string.h>
+#include <stdatomic.h>
 
 /* Pico libs*/
 #include "pico/time.h"
@@ -12,6 +13,7 @@
 #if PICO_ON_DEVICE
 // #include "hardware/clocks.h"
 #include "hardware/vreg.h"
+#include "hardware/sync.h"
 #include "vga.h"
 #else
 #include <SDL2/SDL.h>
@@ -19,8 +21,9 @@
 
 /* Atari and platform includes */
 #include "mos6507/mos6507.h"
+#include "atari/Atari-2600.h"
 #include "atari/Atari-TIA.h"
-#include "atari/Atari-cart.h"
+#include "atari/Atari-TIA-compose.h"
 #include "mos6532/mos6532.h"
 
 // #define PRINT_STATE 1
@@ -40,7 +43,42 @@
 const uint LED_PIN = 25;
 static const sVmode *vmode = NULL;
 struct semaphore vga_start_semaphore;
-static uint32_t screen[SCREEN_WIDTH * SCREEN_HEIGHT];
+/* Pixels are held as palette indexes and only expanded to VGA pixels a
+ * line at a time as they're scanned out, keeping them to a byte each.
+ */
+static uint32_t screen_palette[TIA_PALETTE_COLOURS];
+#if ATARI_RACE_THE_BEAM
+#if ATARI_TIA_PIPELINE
+/* The pipeline draws lines on core 1, which would then be pushing into the
+ * ring it also drains
+ */
+#error "ATARI_RACE_THE_BEAM can't be combined with ATARI_TIA_PIPELINE"
+#endif
+/* Rather than a whole frame, finished lines are passed from the emulator on
+ * core 0 to the scan-out on core 1 through a ring only a few lines deep.
+ * Each line is tagged with where it belongs so the scan-out can tell when
+ * the emulator has fallen behind or got ahead of the display.
+ */
+#define LINE_RING_SIZE 8
+
+typedef struct {
+    uint32_t frame;
+    uint32_t row;
+    uint8_t pixels[SCREEN_WIDTH];
+} ring_line_t;
+
+static ring_line_t line_ring[LINE_RING_SIZE];
+static volatile uint32_t line_ring_head; /* Only written by core 0 */
+static volatile uint32_t line_ring_tail; /* Only written by core 1 */
+static uint32_t frame_count;
+/* Lines the display needed which weren't ready, and lines the emulator
+ * had to wait for room in the ring to queue
+ */
+volatile uint32_t line_ring_underruns;
+volatile uint32_t line_ring_overruns;
+#else
+static uint8_t screen[SCREEN_WIDTH * SCREEN_HEIGHT];
+#endif
 #else
 SDL_Window *window;
 SDL_Surface *window_surface;
@@ -67,6 +105,62 @@ void upscale(uint32_t *src, uint32_t *dest, int src_width, int src_height, int d
 }
 #endif
 
+static atari2600_t atari;
+
+#if PICO_ON_DEVICE && ATARI_RACE_THE_BEAM
+/* Queues a finished line for display. When the ring is full core 0 waits
+ * for the scan-out to take a line, which holds the emulator in step with
+ * the display. Lines are only dropped on core 1, once their row has been
+ * scanned out without them.
+ */
+static void line_ring_push(const uint32_t *pixels, uint32_t row) {
+    uint32_t head = line_ring_head;
+
+    if (head - line_ring_tail >= LINE_RING_SIZE) {
+        line_ring_overruns++;
+        while (head - line_ring_tail >= LINE_RING_SIZE) {
+            tight_loop_contents();
+        }
+        /* Core 1 must be done reading the slot before it's overwritten */
+        __dmb();
+    }
+
+    ring_line_t *line = &line_ring[head % LINE_RING_SIZE];
+    line->frame = frame_count;
+    line->row = row;
+    for (int x = 0; x < SCREEN_WIDTH; x++) {
+        line->pixels[x] = pixels[x];
+    }
+
+    /* The line must be complete before core 1 can see it */
+    __dmb();
+    line_ring_head = head + 1;
+}
+
+/* Finds the line for a display row in the given frame, discarding any which
+ * arrived too late to be shown. Returns NULL if it isn't ready.
+ */
+static const ring_line_t *__time_critical_func(line_ring_peek)(uint32_t frame, uint32_t row) {
+    while (line_ring_tail != line_ring_head) {
+        __dmb();
+        const ring_line_t *line = &line_ring[line_ring_tail % LINE_RING_SIZE];
+        int32_t age = (int32_t)(line->frame - frame);
+
+        if (age < 0 || (age == 0 && line->row < row)) {
+            line_ring_tail++;
+            continue;
+        }
+        if (age == 0 && line->row == row) {
+            return line;
+        }
+        break;
+    }
+
+    line_ring_underruns++;
+    return NULL;
+}
+#endif
+
 #if PICO_ON_DEVICE
 /* Renderer loop on Pico's second core */
 void __time_critical_func(render_loop)() {
@@ -80,128 +174,183 @@ void __time_critical_func(render_loop)() {
         uint32_t *buf = (uint32_t *)&(linebuf->line);
         uint32_t y = linebuf->row;
 
+#if ATARI_RACE_THE_BEAM
+        static uint32_t frame;
+
+        /* Follow whichever frame the emulator is producing as each new
+         * display frame starts
+         */
+        if (y == 25 && line_ring_tail != line_ring_head) {
+            __dmb();
+            frame = line_ring[(line_ring_head - 1) % LINE_RING_SIZE].frame;
+        }
+
+        const ring_line_t *ring_line = NULL;
+        if (y > 24 && y < SCREEN_HEIGHT + 24) {
+            ring_line = line_ring_peek(frame, y - 24);
+        }
+
+        if (ring_line) {
+            for (int x = 0; x < SCREEN_WIDTH; x++) {
+                buf[x] = screen_palette[ring_line->pixels[x]];
+            }
+            /* Only hand the slot back once it's been read */
+            __dmb();
+            line_ring_tail++;
+        } else {
+            memset(buf, 0, 160*4);
+        }
+#else
         if (y > 24 && y < SCREEN_HEIGHT + 24) {
-            memcpy(buf, &screen[(y - 24) * 160], 160 * 4);
+            const uint8_t *line = &screen[(y - 24) * SCREEN_WIDTH];
+            for (int x = 0; x < SCREEN_WIDTH; x++) {
+                buf[x] = screen_palette[line[x]];
+            }
         } else {
             memset(buf, 0, 160*4);
         }
+#endif
 
+#if ATARI_TIA_PIPELINE
+        /* Draw what the emulator has logged while waiting on the next
+         * VGA line, a scanline at a time to keep up with scan-out. When
+         * core 0 is waiting on a collision read this carries on up to the
+         * read, see atari2600_render().
+         */
+        atari2600_render(&atari, 1);
+#endif
     }
 
     __builtin_unreachable();
 }
 #endif
 
-void __time_critical_func(main_loop)() {
-    uint32_t vsync = 0;
-    uint32_t vblank = 0;
-    uint32_t line_count = 0;
-    int i, clock_count = 0;
+static uint32_t vsync = 0;
+static uint32_t vblank = 0;
+static uint32_t line_count = 0;
+/* Cleared to stop the emulator, and on the host whichever thread is drawing */
+static atomic_int running = 1;
 
-    printf("Emulator on Core#%i running...\n", get_core_num());
-
-    for (;;) {
 #if !PICO_ON_DEVICE
-        SDL_Event event;
-        SDL_PollEvent(&event);
-        if (event.type == SDL_QUIT) {
-            if (window != NULL) {
-                SDL_DestroyWindow(window);
-            }
+/* The controls as the keyboard has left them. Only the thread polling SDL
+ * touches these, the console gets a copy through atari2600_set_inputs() as
+ * the CPU may be running on another thread. The fire button starts in the
+ * state the TIA resets to.
+ */
+static uint8_t input_joystick = 0b11111111;
+static uint8_t input_switches;
+static uint8_t input_fire = 1;
+
+static void main_poll_events() {
+    SDL_Event event;
+    if (!SDL_PollEvent(&event)) {
+        return;
+    }
 
-            SDL_Quit();
+    if (event.type == SDL_QUIT) {
+        atomic_store(&running, 0);
+        return;
+    }
+
+    if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) {
+        int pressed = event.type == SDL_KEYDOWN ? 1 : 0;
+        if (event.key.keysym.sym == SDLK_UP) {
+            input_joystick = pressed ? 0b11101111 : 0b11111111;
+        } else if (event.key.keysym.sym == SDLK_DOWN) {
+            input_joystick = pressed ? 0b11011111 : 0b11111111;
+        } else if (event.key.keysym.sym == SDLK_LEFT) {
+            input_joystick = pressed ? 0b10111111 : 0b11111111;
+        } else if (event.key.keysym.sym == SDLK_RIGHT) {
+            input_joystick = pressed ? 0b01111111 : 0b11111111;
+        } else if (event.key.keysym.sym == SDLK_F1) {
+            input_switches = pressed ? 0b00001110 : 0b00001111;
+        } else if (event.key.keysym.sym == SDLK_F2) {
+            input_switches = pressed ? 0b00001101 : 0b00001111;
+        } else if (event.key.keysym.sym == SDLK_F3) {
+            // only toggle
+            if (!pressed) {
+                input_switches ^= (1 << 3);
+            }
+        } else if (event.key.keysym.sym == SDLK_F4) {
+            // only toggle
+            if (!pressed) {
+                input_switches ^= (1 << 6);
+            }
+        } else if (event.key.keysym.sym == SDLK_F5) {
+            // only toggle
+            if (!pressed) {
+                input_switches ^= (1 << 7);
+            }
+        } else if (event.key.keysym.sym == SDLK_SPACE) {
+            input_fire = pressed;
+        } else {
             return;
         }
+        atari2600_set_inputs(&atari, input_joystick, input_switches, input_fire);
+    }
+}
+#endif
 
-        if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) {
-            int pressed = event.type == SDL_KEYDOWN ? 1 : 0;
-            if (event.key.keysym.sym == SDLK_UP) {
-                mos6532_write(SWCHA, pressed ? 0b11101111 : 0b11111111);
-            } else if (event.key.keysym.sym == SDLK_DOWN) {
-                mos6532_write(SWCHA, pressed ? 0b11011111 : 0b11111111);
-            } else if (event.key.keysym.sym == SDLK_LEFT) {
-                mos6532_write(SWCHA, pressed ? 0b10111111 : 0b11111111);
-            } else if (event.key.keysym.sym == SDLK_RIGHT) {
-                mos6532_write(SWCHA, pressed ? 0b01111111 : 0b11111111);
-            } else if (event.key.keysym.sym == SDLK_F1) {
-                mos6532_write(SWCHB, pressed ? 0b00001110 : 0b00001111);    
-            } else if (event.key.keysym.sym == SDLK_F2) {        
-                mos6532_write(SWCHB, pressed ? 0b00001101 : 0b00001111);    
-            } else if (event.key.keysym.sym == SDLK_F3) {
-                // only toggle
-                if (!pressed) {
-                    uint8_t state;
-                    mos6532_read(SWCHB, &state);
-                    mos6532_write(SWCHB, state ^ (1 << 3));    
-                }
-                           } else if (event.key.keysym.sym == SDLK_F4) {
-                // only toggle
-                if (!pressed) {
-                    uint8_t state;
-                    mos6532_read(SWCHB, &state);
-                    mos6532_write(SWCHB, state ^ (1 << 6));    
-                }
-            } else if (event.key.keysym.sym == SDLK_F5) {
-                // only toggle
-                if (!pressed) {
-                    uint8_t state;
-                    mos6532_read(SWCHB, &state);
-                    mos6532_write(SWCHB, state ^ (1 << 7));    
-                }
-            } else if (event.key.keysym.sym == SDLK_SPACE) {
-                TIA_joy1_state(pressed);
-            }
+/* Called once the TIA has produced a full scanline */
+static void __time_critical_func(main_end_of_line)(atari2600_t *atari) {
+    atari_tia *tia = atari2600_video(atari);
 
+    if (vsync && !TIA_get_VSYNC(tia)) {
+#if !PICO_ON_DEVICE
+        /* The window goes once quit has been seen, which may be part way
+         * through a batch of lines
+         */
+        if (!atomic_load(&running)) {
+            return;
         }
+        upscale(screen, window_surface->pixels, SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_WIDTH * 4, SCREEN_HEIGHT * 2);
+        SDL_UpdateWindowSurface(window);
 #endif
 
-        // int c = getchar();
-        // if (c == 27) {
-        //     SDL_Quit();
-        //     return;
-        // }
-        // printf("STEP \r\n");
-
-        for (i = 0; i < TIA_COLOUR_CLOCK_TOTAL; i++) {
-            clock_count = TIA_clock_tick();
-            if (!TIA_get_WSYNC() && !((clock_count + 1) % 3))
-            {
-                mos6532_clock_tick();
-                if (mos6507_clock_tick())
-                {
-                    return;
-                }
-            }
-        }
+#if PICO_ON_DEVICE && ATARI_RACE_THE_BEAM
+        frame_count++;
+#endif
+
+        line_count = 0;
+        vblank = TIA_VERTICAL_BLANK_LINES;
+    }
 
-        if (vsync && !TIA_get_VSYNC()) {
+    vsync = TIA_get_VSYNC(tia);
+
+    if (!vsync && !vblank && (line_count < TIA_VERTICAL_PICTURE_LINES)) {
 #if !PICO_ON_DEVICE
-            upscale(screen, window_surface->pixels, SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_WIDTH * 4, SCREEN_HEIGHT * 2);
-            SDL_UpdateWindowSurface(window);
+        memcpy(&screen[(line_count * SCREEN_WIDTH)], tia->line_buffer, TIA_COLOUR_CLOCK_VISIBLE * 4);
+#elif ATARI_RACE_THE_BEAM
+        line_ring_push(tia->line_buffer, line_count);
+#else
+        uint8_t *line = &screen[(line_count * SCREEN_WIDTH)];
+        for (int x = 0; x < TIA_COLOUR_CLOCK_VISIBLE; x++) {
+            line[x] = tia->line_buffer[x];
+        }
 #endif
 
-            line_count = 0;
-            vblank = TIA_VERTICAL_BLANK_LINES;
-        }
+        TIA_reset_buffer(tia);
+        line_count++;
+    }
 
-        vsync = TIA_get_VSYNC();
+    if (vblank) {
+        vblank--;
+    }
 
-        if (!vsync && !vblank && (line_count < TIA_VERTICAL_PICTURE_LINES)) {
 #if !PICO_ON_DEVICE
-            memcpy(&screen[(line_count * SCREEN_WIDTH)], tia_line_buffer, TIA_COLOUR_CLOCK_VISIBLE * 4);
-#else
-            memcpy(&screen[(line_count * SCREEN_WIDTH)], tia_raw_buffer, TIA_COLOUR_CLOCK_VISIBLE * 4);
+    main_poll_events();
 #endif
+}
 
-            TIA_reset_buffer();
-            line_count++;
-        }
+void __time_critical_func(main_loop)() {
+    printf("Emulator on Core#%i running...\n", get_core_num());
 
-        if (vblank) {
-            vblank--;
+    while (atomic_load_explicit(&running, memory_order_relaxed)) {
+        if (atari2600_step(&atari)) {
+            atomic_store(&running, 0);
+            return;
         }
     }
-    __builtin_unreachable();
 }
 
 /******************************************************************************
@@ -221,6 +370,7 @@ int main()
     gpio_init(LED_PIN);
     gpio_set_dir(LED_PIN, GPIO_OUT);
     vmode = Video(DEV_VGA, RES_HVGA);
+    TIA_palette_build(TIA_PALETTE_RGB222_X4, screen_palette);
     // sleep_ms(5000);
     sem_init(&vga_start_semaphore, 0, 1);
     multicore_launch_core1(render_loop);
@@ -239,18 +389,36 @@ int main()
                               SDL_WINDOW_SHOWN);
 
     window_surface = SDL_GetWindowSurface(window);
+
+    TIA_compose_init();
 #endif
 
     /* Setup and reset all the emulated
      * hardware: memory, CPU, TIA etc ...
      */
-    opcode_populate_ISA_table();
-    mos6532_init();
-    TIA_init();
-
-    /* Emulation is ready to start so load cartridge and reset CPU */
-    cartridge_load(CARTRIDGE);
-    mos6507_reset();
+    atari.line_handler = main_end_of_line;
+    atari2600_init(&atari, CARTRIDGE);
+#if PICO_ON_DEVICE
+    TIA_set_palette_format(atari2600_video(&atari), TIA_PALETTE_INDEX);
+#else
+    mos6532_read(&atari.riot, SWCHB, &input_switches);
+#endif
 
+#if ATARI_TIA_PIPELINE && !PICO_ON_DEVICE
+    /* The CPU gets a thread of its own, leaving this one to draw */
+    multicore_launch_core1(main_loop);
+    while (atomic_load(&running)) {
+        if (!atari2600_render(&atari, TIA_VERTICAL_PICTURE_LINES)) {
+            main_poll_events();
+        }
+    }
+#else
     main_loop();
+#endif
+
+#if !PICO_ON_DEVICE
+    /* Nothing draws once running is cleared, so the window can go */
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+#endif
 }
\ No newline at end of file
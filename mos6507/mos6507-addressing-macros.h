@@ -8,31 +8,31 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&offset); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->offset); \
             if (!condition) { \
                 END_OPCODE() \
                 return 0; \
             } \
             return -1; \
         case 2: \
-            mos6507_increment_PC(); \
-            if (offset & 0x80) { \
-                compliment = ~(offset & 0x7F); \
+            mos6507_increment_PC(cpu); \
+            if (cpu->offset & 0x80) { \
+                compliment = ~(cpu->offset & 0x7F); \
                 compliment++; \
-                addr = mos6507_get_PC() - (compliment & 0x7F); \
+                cpu->addr = mos6507_get_PC(cpu) - (compliment & 0x7F); \
             } else { \
-                addr = mos6507_get_PC() + (offset & 0x7F); \
+                cpu->addr = mos6507_get_PC(cpu) + (cpu->offset & 0x7F); \
             } \
-            if (NOT_SAME_PAGE(mos6507_get_PC(), addr)) { \
+            if (NOT_SAME_PAGE(mos6507_get_PC(cpu), cpu->addr)) { \
                 return -1; \
             } \
-            mos6507_set_PC(addr); \
-            mos6507_set_address_bus(addr); \
+            mos6507_set_PC(cpu, cpu->addr); \
+            mos6507_set_address_bus(cpu, cpu->addr); \
             return 0; \
         case 3: \
-            mos6507_set_PC(addr); \
+            mos6507_set_PC(cpu, cpu->addr); \
         default: \
             break; \
     } \
@@ -44,17 +44,17 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&adl); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->adl); \
             return -1; \
         case 2: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&adh); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->adh); \
             return -1; \
         case 3: \
-            mos6507_set_address_bus_hl(adh, adl); \
+            mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl); \
         default: \
             break; \
     } \
@@ -64,8 +64,8 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
         default: \
             break; \
     } \
@@ -75,12 +75,12 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&adl); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->adl); \
             return -1; \
         case 2: \
-            mos6507_set_address_bus_hl(0, adl); \
+            mos6507_set_address_bus_hl(cpu, 0, cpu->adl); \
         default: \
             break; \
     } \
@@ -90,17 +90,17 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&adl); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->adl); \
             return -1; \
         case 2: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&adh); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->adh); \
             return -1; \
         case 3: \
-            mos6507_set_address_bus_hl(adh, adl); \
+            mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl); \
         default: \
             break; \
     } \
@@ -110,25 +110,25 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&bal); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->bal); \
             return -1; \
         case 2: \
-            mos6507_set_address_bus_hl(0, bal); \
+            mos6507_set_address_bus_hl(cpu, 0, cpu->bal); \
             return -1; \
         case 3: \
-            mos6507_get_register(MOS6507_REG_X, &X); \
-            mos6507_set_address_bus_hl(0, (bal + X)); \
-            memmap_read(&adl); \
+            mos6507_get_register(cpu, MOS6507_REG_X, &X); \
+            mos6507_set_address_bus_hl(cpu, 0, (cpu->bal + X)); \
+            memmap_read(atari, &cpu->adl); \
             return -1; \
         case 4: \
-            mos6507_get_register(MOS6507_REG_X, &X); \
-            mos6507_set_address_bus_hl(0, ((bal + X) + 1)); \
-            memmap_read(&adh); \
+            mos6507_get_register(cpu, MOS6507_REG_X, &X); \
+            mos6507_set_address_bus_hl(cpu, 0, ((cpu->bal + X) + 1)); \
+            memmap_read(atari, &cpu->adh); \
             return -1; \
         case 5: \
-            mos6507_set_address_bus_hl(adh, adl); \
+            mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl); \
         default: \
             break; \
     } \
@@ -138,36 +138,36 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&bal); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->bal); \
             return -1; \
         case 2: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&bah); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->bah); \
             return -1; \
         case 3: \
-            mos6507_get_register(MOS6507_REG_X, &X); \
-            adl = bal + X; \
-            if ((bal + X) & 0x0100) { \
+            mos6507_get_register(cpu, MOS6507_REG_X, &X); \
+            cpu->adl = cpu->bal + X; \
+            if ((cpu->bal + X) & 0x0100) { \
                 c = 1; \
             } \
-            adh = bah + c; \
-            mos6507_set_address_bus_hl(adh, adl); \
-            memmap_read(&data); \
+            cpu->adh = cpu->bah + c; \
+            mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl); \
+            memmap_read(atari, &cpu->data); \
             if (c) { \
                 return -1; \
             } \
             break; \
         case 4: \
-            mos6507_get_register(MOS6507_REG_X, &X); \
-            adl = bal + X; \
-            if ((bal + X) & 0x0100) { \
+            mos6507_get_register(cpu, MOS6507_REG_X, &X); \
+            cpu->adl = cpu->bal + X; \
+            if ((cpu->bal + X) & 0x0100) { \
                 c = 1; \
             } \
-            adh = bah + c; \
-            mos6507_set_address_bus_hl(adh, adl); \
+            cpu->adh = cpu->bah + c; \
+            mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl); \
         default: \
             break; \
     } \
@@ -177,37 +177,72 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&bal); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->bal); \
             return -1; \
         case 2: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&bah); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->bah); \
             return -1; \
         case 3: \
-            mos6507_get_register(MOS6507_REG_Y, &Y); \
-            adl = bal + Y; \
-            if ((bal + Y) & 0x0100) { \
+            mos6507_get_register(cpu, MOS6507_REG_Y, &Y); \
+            cpu->adl = cpu->bal + Y; \
+            if ((cpu->bal + Y) & 0x0100) { \
                 c = 1; \
             } \
-            adh = bah + c; \
-            mos6507_set_address_bus_hl(adh, adl); \
-            memmap_read(&data); \
+            cpu->adh = cpu->bah + c; \
+            mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl); \
+            memmap_read(atari, &cpu->data); \
             if (c) { \
                 return -1; \
             } \
             break; \
         case 4: \
-            mos6507_get_register(MOS6507_REG_Y, &Y); \
-            adl = bal + Y; \
-            if ((bal + Y) & 0x0100) { \
+            mos6507_get_register(cpu, MOS6507_REG_Y, &Y); \
+            cpu->adl = cpu->bal + Y; \
+            if ((cpu->bal + Y) & 0x0100) { \
                 c = 1; \
             } \
-            adh = bah + c; \
-            mos6507_set_address_bus_hl(adh, adl); \
-            memmap_read(&data); \
+            cpu->adh = cpu->bah + c; \
+            mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl); \
+            memmap_read(atari, &cpu->data); \
+        default: \
+            break; \
+    } \
+
+#define FETCH_STORE_ADDRESS_INDIRECT_Y_INDEXED() \
+    switch(cycle) { \
+        case 0: \
+            return -1; \
+        case 1: \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->ial); \
+            return -1; \
+        case 2: \
+            mos6507_set_address_bus_hl(cpu, 0, cpu->ial); \
+            memmap_read(atari, &cpu->bal); \
+            return -1; \
+        case 3: \
+            mos6507_set_address_bus_hl(cpu, 0, cpu->ial+1); \
+            memmap_read(atari, &cpu->bah); \
+            return -1; \
+        case 4: \
+            mos6507_get_register(cpu, MOS6507_REG_Y, &Y); \
+            cpu->adl = cpu->bal + Y; \
+            mos6507_set_address_bus_hl(cpu, cpu->bah, cpu->adl); \
+            memmap_read(atari, &cpu->data); \
+            return -1; \
+        case 5: \
+            mos6507_get_register(cpu, MOS6507_REG_Y, &Y); \
+            cpu->adl = cpu->bal + Y; \
+            if ((cpu->bal + Y) & 0x0100) { \
+                c = 1; \
+            } \
+            cpu->adh = cpu->bah + c; \
+            mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl); \
         default: \
             break; \
     } \
@@ -217,16 +252,16 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&bal); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->bal); \
             return -1; \
         case 2: \
-            mos6507_set_address_bus_hl(0, bal); \
+            mos6507_set_address_bus_hl(cpu, 0, cpu->bal); \
             return -1; \
         case 3: \
-            mos6507_get_register(MOS6507_REG_X, &X); \
-            mos6507_set_address_bus_hl(0, bal + X); \
+            mos6507_get_register(cpu, MOS6507_REG_X, &X); \
+            mos6507_set_address_bus_hl(cpu, 0, cpu->bal + X); \
         default: \
             break; \
     } \
@@ -236,16 +271,16 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&bal); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->bal); \
             return -1; \
         case 2: \
-            mos6507_set_address_bus_hl(0, bal); \
+            mos6507_set_address_bus_hl(cpu, 0, cpu->bal); \
             return -1; \
         case 3: \
-            mos6507_get_register(MOS6507_REG_Y, &Y); \
-            mos6507_set_address_bus_hl(0, bal + Y); \
+            mos6507_get_register(cpu, MOS6507_REG_Y, &Y); \
+            mos6507_set_address_bus_hl(cpu, 0, cpu->bal + Y); \
         default: \
             break; \
     } \
@@ -263,18 +298,18 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&adl); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->adl); \
             return -1; \
         case 2: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&adh); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->adh); \
             return -1; \
         case 3: \
-            mos6507_set_address_bus_hl(adh, adl); \
-            memmap_read(&data); \
+            mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl); \
+            memmap_read(atari, &cpu->data); \
         default: \
             break; \
     } \
@@ -284,9 +319,9 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&data); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->data); \
         default: \
             break; \
     } \
@@ -296,13 +331,13 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&adl); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->adl); \
             return -1; \
         case 2: \
-            mos6507_set_address_bus_hl(0, adl); \
-            memmap_read(&data); \
+            mos6507_set_address_bus_hl(cpu, 0, cpu->adl); \
+            memmap_read(atari, &cpu->data); \
         default: \
             break; \
     } \
@@ -312,18 +347,18 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&adl); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->adl); \
             return -1; \
         case 2: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&adh); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->adh); \
             return -1; \
         case 3: \
-            mos6507_set_address_bus_hl(adh, adl); \
-            memmap_read(&data); \
+            mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl); \
+            memmap_read(atari, &cpu->data); \
         default: \
             break; \
     } \
@@ -333,26 +368,26 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&bal); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->bal); \
             return -1; \
         case 2: \
-            mos6507_set_address_bus_hl(0, bal); \
+            mos6507_set_address_bus_hl(cpu, 0, cpu->bal); \
             return -1; \
         case 3: \
-            mos6507_get_register(MOS6507_REG_X, &X); \
-            mos6507_set_address_bus_hl(0, (bal + X)); \
-            memmap_read(&adl); \
+            mos6507_get_register(cpu, MOS6507_REG_X, &X); \
+            mos6507_set_address_bus_hl(cpu, 0, (cpu->bal + X)); \
+            memmap_read(atari, &cpu->adl); \
             return -1; \
         case 4: \
-            mos6507_get_register(MOS6507_REG_X, &X); \
-            mos6507_set_address_bus_hl(0, ((bal + X) + 1)); \
-            memmap_read(&adh); \
+            mos6507_get_register(cpu, MOS6507_REG_X, &X); \
+            mos6507_set_address_bus_hl(cpu, 0, ((cpu->bal + X) + 1)); \
+            memmap_read(atari, &cpu->adh); \
             return -1; \
         case 5: \
-            mos6507_set_address_bus_hl(adh, adl); \
-            memmap_read(&data); \
+            mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl); \
+            memmap_read(atari, &cpu->data); \
         default: \
             break; \
     } \
@@ -362,40 +397,40 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&ial); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->ial); \
             return -1; \
         case 2: \
-            mos6507_set_address_bus_hl(0, ial); \
-            memmap_read(&bal); \
+            mos6507_set_address_bus_hl(cpu, 0, cpu->ial); \
+            memmap_read(atari, &cpu->bal); \
             return -1; \
         case 3: \
-            mos6507_set_address_bus_hl(0, ial+1); \
-            memmap_read(&bah); \
+            mos6507_set_address_bus_hl(cpu, 0, cpu->ial+1); \
+            memmap_read(atari, &cpu->bah); \
             return -1; \
         case 4: \
-            mos6507_get_register(MOS6507_REG_Y, &Y); \
-            adl = bal + Y; \
-            if ((bal + Y) & 0x0100) { \
+            mos6507_get_register(cpu, MOS6507_REG_Y, &Y); \
+            cpu->adl = cpu->bal + Y; \
+            if ((cpu->bal + Y) & 0x0100) { \
                 c = 1; \
             } \
-            adh = bah + c; \
-            mos6507_set_address_bus_hl(adh, adl); \
-            memmap_read(&data); \
+            cpu->adh = cpu->bah + c; \
+            mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl); \
+            memmap_read(atari, &cpu->data); \
             if (c) { \
                 return -1; \
             } \
             break; \
         case 5: \
-            mos6507_get_register(MOS6507_REG_Y, &Y); \
-            adl = bal + Y; \
-            if ((bal + Y) & 0x0100) { \
+            mos6507_get_register(cpu, MOS6507_REG_Y, &Y); \
+            cpu->adl = cpu->bal + Y; \
+            if ((cpu->bal + Y) & 0x0100) { \
                 c = 1; \
             } \
-            adh = bah + c; \
-            mos6507_set_address_bus_hl(adh, adl); \
-            memmap_read(&data); \
+            cpu->adh = cpu->bah + c; \
+            mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl); \
+            memmap_read(atari, &cpu->data); \
         default: \
             break; \
     } \
@@ -405,37 +440,37 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&bal); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->bal); \
             return -1; \
         case 2: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&bah); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->bah); \
             return -1; \
         case 3: \
-            mos6507_get_register(MOS6507_REG_X, &X); \
-            adl = bal + X; \
-            if ((bal + X) & 0x0100) { \
+            mos6507_get_register(cpu, MOS6507_REG_X, &X); \
+            cpu->adl = cpu->bal + X; \
+            if ((cpu->bal + X) & 0x0100) { \
                 c = 1; \
             } \
-            adh = bah + c; \
-            mos6507_set_address_bus_hl(adh, adl); \
-            memmap_read(&data); \
+            cpu->adh = cpu->bah + c; \
+            mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl); \
+            memmap_read(atari, &cpu->data); \
             if (c) { \
                 return -1; \
             } \
             break; \
         case 4: \
-            mos6507_get_register(MOS6507_REG_X, &X); \
-            adl = bal + X; \
-            if ((bal + X) & 0x0100) { \
+            mos6507_get_register(cpu, MOS6507_REG_X, &X); \
+            cpu->adl = cpu->bal + X; \
+            if ((cpu->bal + X) & 0x0100) { \
                 c = 1; \
             } \
-            adh = bah + c; \
-            mos6507_set_address_bus_hl(adh, adl); \
-            memmap_read(&data); \
+            cpu->adh = cpu->bah + c; \
+            mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl); \
+            memmap_read(atari, &cpu->data); \
         default: \
             break; \
     } \
@@ -445,37 +480,37 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&bal); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->bal); \
             return -1; \
         case 2: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&bah); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->bah); \
             return -1; \
         case 3: \
-            mos6507_get_register(MOS6507_REG_Y, &Y); \
-            adl = bal + Y; \
-            if ((bal + Y) & 0x0100) { \
+            mos6507_get_register(cpu, MOS6507_REG_Y, &Y); \
+            cpu->adl = cpu->bal + Y; \
+            if ((cpu->bal + Y) & 0x0100) { \
                 c = 1; \
             } \
-            adh = bah + c; \
-            mos6507_set_address_bus_hl(adh, adl); \
-            memmap_read(&data); \
+            cpu->adh = cpu->bah + c; \
+            mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl); \
+            memmap_read(atari, &cpu->data); \
             if (c) { \
                 return -1; \
             } \
             break; \
         case 4: \
-            mos6507_get_register(MOS6507_REG_Y, &Y); \
-            adl = bal + Y; \
-            if ((bal + Y) & 0x0100) { \
+            mos6507_get_register(cpu, MOS6507_REG_Y, &Y); \
+            cpu->adl = cpu->bal + Y; \
+            if ((cpu->bal + Y) & 0x0100) { \
                 c = 1; \
             } \
-            adh = bah + c; \
-            mos6507_set_address_bus_hl(adh, adl); \
-            memmap_read(&data); \
+            cpu->adh = cpu->bah + c; \
+            mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl); \
+            memmap_read(atari, &cpu->data); \
         default: \
             break; \
     } \
@@ -485,17 +520,17 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&bal); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->bal); \
             return -1; \
         case 2: \
-            mos6507_set_address_bus_hl(0, bal); \
+            mos6507_set_address_bus_hl(cpu, 0, cpu->bal); \
             return -1; \
         case 3: \
-            mos6507_get_register(MOS6507_REG_X, &X); \
-            mos6507_set_address_bus_hl(0, bal + X); \
-            memmap_read(&data); \
+            mos6507_get_register(cpu, MOS6507_REG_X, &X); \
+            mos6507_set_address_bus_hl(cpu, 0, cpu->bal + X); \
+            memmap_read(atari, &cpu->data); \
         default: \
             break; \
     } \
@@ -505,17 +540,17 @@
         case 0: \
             return -1; \
         case 1: \
-            mos6507_increment_PC(); \
-            mos6507_set_address_bus(mos6507_get_PC()); \
-            memmap_read(&bal); \
+            mos6507_increment_PC(cpu); \
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu)); \
+            memmap_read(atari, &cpu->bal); \
             return -1; \
         case 2: \
-            mos6507_set_address_bus_hl(0, bal); \
+            mos6507_set_address_bus_hl(cpu, 0, cpu->bal); \
             return -1; \
         case 3: \
-            mos6507_get_register(MOS6507_REG_Y, &Y); \
-            mos6507_set_address_bus_hl(0, bal + Y); \
-            memmap_read(&data); \
+            mos6507_get_register(cpu, MOS6507_REG_Y, &Y); \
+            mos6507_set_address_bus_hl(cpu, 0, cpu->bal + Y); \
+            memmap_read(atari, &cpu->data); \
         default: \
             break; \
     } \
@@ -550,6 +585,8 @@
         FETCH_STORE_ADDRESS_ABSOLUTE() \
     } else if (OPCODE_ADDRESSING_MODE_INDIRECT_X_INDEXED == address_mode) { \
         FETCH_STORE_ADDRESS_INDIRECT_X_INDEXED() \
+    } else if (OPCODE_ADDRESSING_MODE_INDIRECT_Y_INDEXED == address_mode) { \
+        FETCH_STORE_ADDRESS_INDIRECT_Y_INDEXED() \
     } else if (OPCODE_ADDRESSING_MODE_ABSOLUTE_X_INDEXED == address_mode) { \
         FETCH_STORE_ADDRESS_ABSOLUTE_X_INDEXED() \
     } else if (OPCODE_ADDRESSING_MODE_ABSOLUTE_Y_INDEXED == address_mode) { \
@@ -0,0 +1,1598 @@
+/*
+ * File: mos6507-interpreter.c
+ *
+ * Instruction-level execution of the 6507. Rather than being re-entered on
+ * every clock cycle, each call runs a complete instruction and reports how
+ * many cycles it consumed. Bus accesses are stamped with the cycle they
+ * occur on so memory mapped devices can be caught up before they're touched.
+ *
+ * Cycle counts and bus access ordering follow:
+ * http://users.telenet.be/kim1-6502/6502/hwman.html##AA
+ */
+
+#include "../atari/Atari-2600.h"
+#include "../atari/Atari-memmap.h"
+#include "mos6507.h"
+#include "mos6507-microcode.h"
+#include "mos6507-interpreter.h"
+
+/* Bitwise calculation of whether two addresses
+ * are on the same page. Courtesy of stella, emucode/MOS6502.m4:28
+ */
+#define NOT_SAME_PAGE(_addr1, _addr2) (((_addr1) ^ (_addr2)) & 0xFF00)
+
+/******************************************************************************
+ * Bus access
+ *
+ * cycle is the zero based cycle of the current instruction the access lands
+ * on; cycle 0 is always the op-code fetch.
+ *****************************************************************************/
+
+static inline uint8_t bus_read(atari2600_t *atari, uint16_t address, uint8_t cycle)
+{
+    uint8_t data = 0;
+    memmap_set_bus_cycle(atari, cycle);
+    mos6507_set_address_bus(&atari->cpu, address);
+    memmap_read(atari, &data);
+    return data;
+}
+
+static inline void bus_write(atari2600_t *atari, uint16_t address, uint8_t cycle, uint8_t data)
+{
+    memmap_set_bus_cycle(atari, cycle);
+    mos6507_set_address_bus(&atari->cpu, address);
+    mos6507_set_data_bus(&atari->cpu, data);
+    memmap_write(atari);
+}
+
+static inline void bus_push(atari2600_t *atari, uint8_t cycle, uint8_t data)
+{
+    memmap_set_bus_cycle(atari, cycle);
+    mos6507_push_stack(atari, data);
+}
+
+static inline uint8_t bus_pull(atari2600_t *atari, uint8_t cycle)
+{
+    uint8_t data = 0;
+    memmap_set_bus_cycle(atari, cycle);
+    mos6507_pull_stack(atari, &data);
+    return data;
+}
+
+/******************************************************************************
+ * Effective address calculation
+ *
+ * Each function resolves the address an operand refers to, performing any
+ * pointer fetches on the cycles real hardware would. page_crossed is set
+ * when indexing carried into the high byte.
+ *****************************************************************************/
+
+static inline uint16_t address_ZERO_PAGE(atari2600_t *atari, uint16_t operand, int *page_crossed)
+{
+    return operand & 0xFF;
+}
+
+static inline uint16_t address_ZERO_PAGE_X_INDEXED(atari2600_t *atari, uint16_t operand, int *page_crossed)
+{
+    uint8_t X = atari->cpu.X;
+    return (operand + X) & 0xFF;
+}
+
+static inline uint16_t address_ZERO_PAGE_Y_INDEXED(atari2600_t *atari, uint16_t operand, int *page_crossed)
+{
+    uint8_t Y = atari->cpu.Y;
+    return (operand + Y) & 0xFF;
+}
+
+static inline uint16_t address_ABSOLUTE(atari2600_t *atari, uint16_t operand, int *page_crossed)
+{
+    return operand;
+}
+
+static inline uint16_t address_ABSOLUTE_X_INDEXED(atari2600_t *atari, uint16_t operand, int *page_crossed)
+{
+    uint8_t X = atari->cpu.X;
+    uint16_t address;
+    address = operand + X;
+    *page_crossed = NOT_SAME_PAGE(operand, address) ? 1 : 0;
+    return address;
+}
+
+static inline uint16_t address_ABSOLUTE_Y_INDEXED(atari2600_t *atari, uint16_t operand, int *page_crossed)
+{
+    uint8_t Y = atari->cpu.Y;
+    uint16_t address;
+    address = operand + Y;
+    *page_crossed = NOT_SAME_PAGE(operand, address) ? 1 : 0;
+    return address;
+}
+
+static inline uint16_t address_INDIRECT_X_INDEXED(atari2600_t *atari, uint16_t operand, int *page_crossed)
+{
+    uint8_t X = atari->cpu.X, adl, adh;
+    adl = bus_read(atari, (operand + X) & 0xFF, 3);
+    adh = bus_read(atari, (operand + X + 1) & 0xFF, 4);
+    return (adh << 8) | adl;
+}
+
+static inline uint16_t address_INDIRECT_Y_INDEXED(atari2600_t *atari, uint16_t operand, int *page_crossed)
+{
+    uint8_t Y = atari->cpu.Y, bal, bah;
+    uint16_t base;
+    bal = bus_read(atari, operand & 0xFF, 2);
+    bah = bus_read(atari, (operand + 1) & 0xFF, 3);
+    base = (bah << 8) | bal;
+    *page_crossed = NOT_SAME_PAGE(base, base + Y) ? 1 : 0;
+    return base + Y;
+}
+
+/* Cycles taken to store through each addressing mode. Loads take the same
+ * time, except indexed absolute and indirect Y loads which save a cycle
+ * when no page boundary is crossed. Read-modify-write takes two more.
+ */
+#define STORE_CYCLES_ZERO_PAGE              3
+#define STORE_CYCLES_ZERO_PAGE_X_INDEXED    4
+#define STORE_CYCLES_ZERO_PAGE_Y_INDEXED    4
+#define STORE_CYCLES_ABSOLUTE               4
+#define STORE_CYCLES_ABSOLUTE_X_INDEXED     5
+#define STORE_CYCLES_ABSOLUTE_Y_INDEXED     5
+#define STORE_CYCLES_INDIRECT_X_INDEXED     6
+#define STORE_CYCLES_INDIRECT_Y_INDEXED     6
+
+#define PAGE_PENALTY_ZERO_PAGE              0
+#define PAGE_PENALTY_ZERO_PAGE_X_INDEXED    0
+#define PAGE_PENALTY_ZERO_PAGE_Y_INDEXED    0
+#define PAGE_PENALTY_ABSOLUTE               0
+#define PAGE_PENALTY_ABSOLUTE_X_INDEXED     1
+#define PAGE_PENALTY_ABSOLUTE_Y_INDEXED     1
+#define PAGE_PENALTY_INDIRECT_X_INDEXED     0
+#define PAGE_PENALTY_INDIRECT_Y_INDEXED     1
+
+/******************************************************************************
+ * Instruction templates
+ *
+ * Each template expands into a handler specialised for a single op-code, so
+ * dispatching an instruction costs exactly one indirect call. The threaded
+ * loop further down inlines them all, so there it costs none.
+ *****************************************************************************/
+
+#define INSTRUCTION_HANDLER static inline __attribute__((always_inline)) int
+
+/* Reads a value from memory and operates on it within the CPU */
+#define LOAD_INSTRUCTION(_opcode, _mode, _operation) \
+    INSTRUCTION_HANDLER instruction_##_opcode(atari2600_t *atari, uint16_t operand) \
+    { \
+        mos6507 *cpu = &atari->cpu; \
+        int page_crossed = 0; \
+        uint16_t address = address_##_mode(atari, operand, &page_crossed); \
+        int cycles = STORE_CYCLES_##_mode - PAGE_PENALTY_##_mode \
+                   + (page_crossed & PAGE_PENALTY_##_mode); \
+        uint8_t data = bus_read(atari, address, cycles - 1); \
+        _operation(cpu, data); \
+        return cycles; \
+    }
+
+/* As above, but the value is the operand itself */
+#define IMMEDIATE_INSTRUCTION(_opcode, _operation) \
+    INSTRUCTION_HANDLER instruction_##_opcode(atari2600_t *atari, uint16_t operand) \
+    { \
+        mos6507 *cpu = &atari->cpu; \
+        _operation(cpu, (uint8_t)operand); \
+        return 2; \
+    }
+
+/* Writes a value taken from the registers to memory on the final cycle */
+#define STORE_INSTRUCTION(_opcode, _mode, _value) \
+    INSTRUCTION_HANDLER instruction_##_opcode(atari2600_t *atari, uint16_t operand) \
+    { \
+        mos6507 *cpu = &atari->cpu; \
+        int page_crossed = 0; \
+        uint16_t address = address_##_mode(atari, operand, &page_crossed); \
+        bus_write(atari, address, STORE_CYCLES_##_mode - 1, (_value)); \
+        return STORE_CYCLES_##_mode; \
+    }
+
+/* The unstable undocumented stores AND the value with the high byte of the
+ * base address plus one. When indexing carries into the high byte, that is
+ * replaced by the value as well.
+ */
+#define STORE_HIGH_INSTRUCTION(_opcode, _mode, _value) \
+    INSTRUCTION_HANDLER instruction_##_opcode(atari2600_t *atari, uint16_t operand) \
+    { \
+        mos6507 *cpu = &atari->cpu; \
+        int page_crossed = 0; \
+        uint16_t address = address_##_mode(atari, operand, &page_crossed); \
+        uint8_t data = (_value) & ((address >> 8) - page_crossed + 1); \
+        if (page_crossed) { \
+            address = (data << 8) | (address & 0xFF); \
+        } \
+        bus_write(atari, address, STORE_CYCLES_##_mode - 1, data); \
+        return STORE_CYCLES_##_mode; \
+    }
+
+/* Reads a value, writes it straight back unmodified (as the real part does)
+ * and then writes the result on the final cycle.
+ */
+#define MODIFY_INSTRUCTION(_opcode, _mode, _operation) \
+    INSTRUCTION_HANDLER instruction_##_opcode(atari2600_t *atari, uint16_t operand) \
+    { \
+        mos6507 *cpu = &atari->cpu; \
+        int page_crossed = 0; \
+        int cycles = STORE_CYCLES_##_mode + 2; \
+        uint16_t address = address_##_mode(atari, operand, &page_crossed); \
+        uint8_t data = bus_read(atari, address, cycles - 3); \
+        bus_write(atari, address, cycles - 2, data); \
+        _operation(cpu, &data); \
+        bus_write(atari, address, cycles - 1, data); \
+        return cycles; \
+    }
+
+/* Single byte, two cycle instructions */
+#define IMPLIED_INSTRUCTION(_opcode, _operation) \
+    INSTRUCTION_HANDLER instruction_##_opcode(atari2600_t *atari, uint16_t operand) \
+    { \
+        mos6507 *cpu = &atari->cpu; \
+        _operation; \
+        return 2; \
+    }
+
+/* Taken branches add a cycle, and another if they cross a page */
+#define BRANCH_INSTRUCTION(_opcode, _condition) \
+    INSTRUCTION_HANDLER instruction_##_opcode(atari2600_t *atari, uint16_t operand) \
+    { \
+        mos6507 *cpu = &atari->cpu; \
+        return branch(cpu, (_condition), (uint8_t)operand); \
+    }
+
+static inline int branch(mos6507 *cpu, int condition, uint8_t offset)
+{
+    uint16_t pc, target;
+
+    if (!condition) {
+        return 2;
+    }
+    pc = mos6507_get_PC(cpu);
+    target = pc + (int8_t)offset;
+    mos6507_set_PC(cpu, target);
+    return NOT_SAME_PAGE(pc, target) ? 4 : 3;
+}
+
+/******************************************************************************
+ * Operations which have no microcode helper
+ *****************************************************************************/
+
+static inline void set_NZ(mos6507 *cpu, uint8_t value)
+{
+    mos6507_set_NZ(cpu, value);
+}
+
+static inline void transfer(mos6507 *cpu, mos6507_register_t source, mos6507_register_t destination, int flags)
+{
+    uint8_t value;
+    mos6507_get_register(cpu, source, &value);
+    mos6507_set_register(cpu, destination, value);
+    if (flags) {
+        set_NZ(cpu, value);
+    }
+}
+
+static inline void step_register(mos6507 *cpu, mos6507_register_t reg, int8_t delta)
+{
+    uint8_t value;
+    mos6507_get_register(cpu, reg, &value);
+    value += delta;
+    mos6507_set_register(cpu, reg, value);
+    set_NZ(cpu, value);
+}
+
+static inline void load_A(mos6507 *cpu, uint8_t data) { cpu->A = data; set_NZ(cpu, data); }
+static inline void load_X(mos6507 *cpu, uint8_t data) { cpu->X = data; set_NZ(cpu, data); }
+static inline void load_Y(mos6507 *cpu, uint8_t data) { cpu->Y = data; set_NZ(cpu, data); }
+static inline void ora(mos6507 *cpu, uint8_t data) { mos6507_ORA(cpu, &data); }
+static inline void nop(mos6507 *cpu, uint8_t data) { }
+static inline void increment(mos6507 *cpu, uint8_t *data) { (*data)++; set_NZ(cpu, *data); }
+static inline void decrement(mos6507 *cpu, uint8_t *data) { (*data)--; set_NZ(cpu, *data); }
+
+/******************************************************************************
+ * Instruction set
+ *****************************************************************************/
+
+/* Load and store */
+IMMEDIATE_INSTRUCTION(0xA9, load_A)
+LOAD_INSTRUCTION(0xA5, ZERO_PAGE, load_A)
+LOAD_INSTRUCTION(0xB5, ZERO_PAGE_X_INDEXED, load_A)
+LOAD_INSTRUCTION(0xAD, ABSOLUTE, load_A)
+LOAD_INSTRUCTION(0xBD, ABSOLUTE_X_INDEXED, load_A)
+LOAD_INSTRUCTION(0xB9, ABSOLUTE_Y_INDEXED, load_A)
+LOAD_INSTRUCTION(0xA1, INDIRECT_X_INDEXED, load_A)
+LOAD_INSTRUCTION(0xB1, INDIRECT_Y_INDEXED, load_A)
+
+IMMEDIATE_INSTRUCTION(0xA2, load_X)
+LOAD_INSTRUCTION(0xA6, ZERO_PAGE, load_X)
+LOAD_INSTRUCTION(0xB6, ZERO_PAGE_Y_INDEXED, load_X)
+LOAD_INSTRUCTION(0xAE, ABSOLUTE, load_X)
+LOAD_INSTRUCTION(0xBE, ABSOLUTE_Y_INDEXED, load_X)
+
+IMMEDIATE_INSTRUCTION(0xA0, load_Y)
+LOAD_INSTRUCTION(0xA4, ZERO_PAGE, load_Y)
+LOAD_INSTRUCTION(0xB4, ZERO_PAGE_X_INDEXED, load_Y)
+LOAD_INSTRUCTION(0xAC, ABSOLUTE, load_Y)
+LOAD_INSTRUCTION(0xBC, ABSOLUTE_X_INDEXED, load_Y)
+
+STORE_INSTRUCTION(0x85, ZERO_PAGE, cpu->A)
+STORE_INSTRUCTION(0x95, ZERO_PAGE_X_INDEXED, cpu->A)
+STORE_INSTRUCTION(0x8D, ABSOLUTE, cpu->A)
+STORE_INSTRUCTION(0x9D, ABSOLUTE_X_INDEXED, cpu->A)
+STORE_INSTRUCTION(0x99, ABSOLUTE_Y_INDEXED, cpu->A)
+STORE_INSTRUCTION(0x81, INDIRECT_X_INDEXED, cpu->A)
+STORE_INSTRUCTION(0x91, INDIRECT_Y_INDEXED, cpu->A)
+
+STORE_INSTRUCTION(0x86, ZERO_PAGE, cpu->X)
+STORE_INSTRUCTION(0x96, ZERO_PAGE_Y_INDEXED, cpu->X)
+STORE_INSTRUCTION(0x8E, ABSOLUTE, cpu->X)
+
+STORE_INSTRUCTION(0x84, ZERO_PAGE, cpu->Y)
+STORE_INSTRUCTION(0x94, ZERO_PAGE_X_INDEXED, cpu->Y)
+STORE_INSTRUCTION(0x8C, ABSOLUTE, cpu->Y)
+
+/* Arithmetic */
+IMMEDIATE_INSTRUCTION(0x69, mos6507_ADC)
+LOAD_INSTRUCTION(0x65, ZERO_PAGE, mos6507_ADC)
+LOAD_INSTRUCTION(0x75, ZERO_PAGE_X_INDEXED, mos6507_ADC)
+LOAD_INSTRUCTION(0x6D, ABSOLUTE, mos6507_ADC)
+LOAD_INSTRUCTION(0x7D, ABSOLUTE_X_INDEXED, mos6507_ADC)
+LOAD_INSTRUCTION(0x79, ABSOLUTE_Y_INDEXED, mos6507_ADC)
+LOAD_INSTRUCTION(0x61, INDIRECT_X_INDEXED, mos6507_ADC)
+LOAD_INSTRUCTION(0x71, INDIRECT_Y_INDEXED, mos6507_ADC)
+
+IMMEDIATE_INSTRUCTION(0xE9, mos6507_SBC)
+LOAD_INSTRUCTION(0xE5, ZERO_PAGE, mos6507_SBC)
+LOAD_INSTRUCTION(0xF5, ZERO_PAGE_X_INDEXED, mos6507_SBC)
+LOAD_INSTRUCTION(0xED, ABSOLUTE, mos6507_SBC)
+LOAD_INSTRUCTION(0xFD, ABSOLUTE_X_INDEXED, mos6507_SBC)
+LOAD_INSTRUCTION(0xF9, ABSOLUTE_Y_INDEXED, mos6507_SBC)
+LOAD_INSTRUCTION(0xE1, INDIRECT_X_INDEXED, mos6507_SBC)
+LOAD_INSTRUCTION(0xF1, INDIRECT_Y_INDEXED, mos6507_SBC)
+
+/* Increment and decrement */
+MODIFY_INSTRUCTION(0xE6, ZERO_PAGE, increment)
+MODIFY_INSTRUCTION(0xF6, ZERO_PAGE_X_INDEXED, increment)
+MODIFY_INSTRUCTION(0xEE, ABSOLUTE, increment)
+MODIFY_INSTRUCTION(0xFE, ABSOLUTE_X_INDEXED, increment)
+IMPLIED_INSTRUCTION(0xE8, step_register(cpu, MOS6507_REG_X, 1))
+IMPLIED_INSTRUCTION(0xC8, step_register(cpu, MOS6507_REG_Y, 1))
+
+MODIFY_INSTRUCTION(0xC6, ZERO_PAGE, decrement)
+MODIFY_INSTRUCTION(0xD6, ZERO_PAGE_X_INDEXED, decrement)
+MODIFY_INSTRUCTION(0xCE, ABSOLUTE, decrement)
+MODIFY_INSTRUCTION(0xDE, ABSOLUTE_X_INDEXED, decrement)
+IMPLIED_INSTRUCTION(0xCA, step_register(cpu, MOS6507_REG_X, -1))
+IMPLIED_INSTRUCTION(0x88, step_register(cpu, MOS6507_REG_Y, -1))
+
+/* Logical */
+IMMEDIATE_INSTRUCTION(0x29, mos6507_AND)
+LOAD_INSTRUCTION(0x25, ZERO_PAGE, mos6507_AND)
+LOAD_INSTRUCTION(0x35, ZERO_PAGE_X_INDEXED, mos6507_AND)
+LOAD_INSTRUCTION(0x2D, ABSOLUTE, mos6507_AND)
+LOAD_INSTRUCTION(0x3D, ABSOLUTE_X_INDEXED, mos6507_AND)
+LOAD_INSTRUCTION(0x39, ABSOLUTE_Y_INDEXED, mos6507_AND)
+LOAD_INSTRUCTION(0x21, INDIRECT_X_INDEXED, mos6507_AND)
+LOAD_INSTRUCTION(0x31, INDIRECT_Y_INDEXED, mos6507_AND)
+
+IMMEDIATE_INSTRUCTION(0x09, ora)
+LOAD_INSTRUCTION(0x05, ZERO_PAGE, ora)
+LOAD_INSTRUCTION(0x15, ZERO_PAGE_X_INDEXED, ora)
+LOAD_INSTRUCTION(0x0D, ABSOLUTE, ora)
+LOAD_INSTRUCTION(0x1D, ABSOLUTE_X_INDEXED, ora)
+LOAD_INSTRUCTION(0x19, ABSOLUTE_Y_INDEXED, ora)
+LOAD_INSTRUCTION(0x01, INDIRECT_X_INDEXED, ora)
+LOAD_INSTRUCTION(0x11, INDIRECT_Y_INDEXED, ora)
+
+IMMEDIATE_INSTRUCTION(0x49, mos6507_EOR)
+LOAD_INSTRUCTION(0x45, ZERO_PAGE, mos6507_EOR)
+LOAD_INSTRUCTION(0x55, ZERO_PAGE_X_INDEXED, mos6507_EOR)
+LOAD_INSTRUCTION(0x4D, ABSOLUTE, mos6507_EOR)
+LOAD_INSTRUCTION(0x5D, ABSOLUTE_X_INDEXED, mos6507_EOR)
+LOAD_INSTRUCTION(0x59, ABSOLUTE_Y_INDEXED, mos6507_EOR)
+LOAD_INSTRUCTION(0x41, INDIRECT_X_INDEXED, mos6507_EOR)
+LOAD_INSTRUCTION(0x51, INDIRECT_Y_INDEXED, mos6507_EOR)
+
+/* Jump, branch, compare and test */
+INSTRUCTION_HANDLER instruction_0x4C(atari2600_t *atari, uint16_t operand)
+{
+    mos6507 *cpu = &atari->cpu;
+    mos6507_set_PC(cpu, operand);
+    return 3;
+}
+
+INSTRUCTION_HANDLER instruction_0x6C(atari2600_t *atari, uint16_t operand)
+{
+    mos6507 *cpu = &atari->cpu;
+    /* The pointer's high byte is fetched without carrying into the page */
+    uint8_t adl = bus_read(atari, operand, 3);
+    uint8_t adh = bus_read(atari, (operand & 0xFF00) | ((operand + 1) & 0x00FF), 4);
+    mos6507_set_PC_hl(cpu, adh, adl);
+    return 5;
+}
+
+BRANCH_INSTRUCTION(0x90, !cpu->C)
+BRANCH_INSTRUCTION(0xB0, cpu->C)
+BRANCH_INSTRUCTION(0xF0, !cpu->Z)
+BRANCH_INSTRUCTION(0xD0, cpu->Z)
+BRANCH_INSTRUCTION(0x30, cpu->N & 0x80)
+BRANCH_INSTRUCTION(0x10, !(cpu->N & 0x80))
+BRANCH_INSTRUCTION(0x70, cpu->V)
+BRANCH_INSTRUCTION(0x50, !cpu->V)
+
+IMMEDIATE_INSTRUCTION(0xC9, mos6507_CMP)
+LOAD_INSTRUCTION(0xC5, ZERO_PAGE, mos6507_CMP)
+LOAD_INSTRUCTION(0xD5, ZERO_PAGE_X_INDEXED, mos6507_CMP)
+LOAD_INSTRUCTION(0xCD, ABSOLUTE, mos6507_CMP)
+LOAD_INSTRUCTION(0xDD, ABSOLUTE_X_INDEXED, mos6507_CMP)
+LOAD_INSTRUCTION(0xD9, ABSOLUTE_Y_INDEXED, mos6507_CMP)
+LOAD_INSTRUCTION(0xC1, INDIRECT_X_INDEXED, mos6507_CMP)
+LOAD_INSTRUCTION(0xD1, INDIRECT_Y_INDEXED, mos6507_CMP)
+
+IMMEDIATE_INSTRUCTION(0xE0, mos6507_CPX)
+LOAD_INSTRUCTION(0xE4, ZERO_PAGE, mos6507_CPX)
+LOAD_INSTRUCTION(0xEC, ABSOLUTE, mos6507_CPX)
+
+IMMEDIATE_INSTRUCTION(0xC0, mos6507_CPY)
+LOAD_INSTRUCTION(0xC4, ZERO_PAGE, mos6507_CPY)
+LOAD_INSTRUCTION(0xCC, ABSOLUTE, mos6507_CPY)
+
+LOAD_INSTRUCTION(0x24, ZERO_PAGE, mos6507_BIT)
+LOAD_INSTRUCTION(0x2C, ABSOLUTE, mos6507_BIT)
+
+/* Shift and rotate */
+IMPLIED_INSTRUCTION(0x0A, mos6507_ASL_Accumulator(cpu))
+MODIFY_INSTRUCTION(0x06, ZERO_PAGE, mos6507_ASL)
+MODIFY_INSTRUCTION(0x16, ZERO_PAGE_X_INDEXED, mos6507_ASL)
+MODIFY_INSTRUCTION(0x0E, ABSOLUTE, mos6507_ASL)
+MODIFY_INSTRUCTION(0x1E, ABSOLUTE_X_INDEXED, mos6507_ASL)
+
+IMPLIED_INSTRUCTION(0x4A, mos6507_LSR_Accumulator(cpu))
+MODIFY_INSTRUCTION(0x46, ZERO_PAGE, mos6507_LSR)
+MODIFY_INSTRUCTION(0x56, ZERO_PAGE_X_INDEXED, mos6507_LSR)
+MODIFY_INSTRUCTION(0x4E, ABSOLUTE, mos6507_LSR)
+MODIFY_INSTRUCTION(0x5E, ABSOLUTE_X_INDEXED, mos6507_LSR)
+
+IMPLIED_INSTRUCTION(0x2A, mos6507_ROL_Accumulator(cpu))
+MODIFY_INSTRUCTION(0x26, ZERO_PAGE, mos6507_ROL)
+MODIFY_INSTRUCTION(0x36, ZERO_PAGE_X_INDEXED, mos6507_ROL)
+MODIFY_INSTRUCTION(0x2E, ABSOLUTE, mos6507_ROL)
+MODIFY_INSTRUCTION(0x3E, ABSOLUTE_X_INDEXED, mos6507_ROL)
+
+IMPLIED_INSTRUCTION(0x6A, mos6507_ROR_Accumulator(cpu))
+MODIFY_INSTRUCTION(0x66, ZERO_PAGE, mos6507_ROR)
+MODIFY_INSTRUCTION(0x76, ZERO_PAGE_X_INDEXED, mos6507_ROR)
+MODIFY_INSTRUCTION(0x6E, ABSOLUTE, mos6507_ROR)
+MODIFY_INSTRUCTION(0x7E, ABSOLUTE_X_INDEXED, mos6507_ROR)
+
+/* Transfer */
+IMPLIED_INSTRUCTION(0xAA, transfer(cpu, MOS6507_REG_A, MOS6507_REG_X, 1))
+IMPLIED_INSTRUCTION(0xA8, transfer(cpu, MOS6507_REG_A, MOS6507_REG_Y, 1))
+IMPLIED_INSTRUCTION(0x8A, transfer(cpu, MOS6507_REG_X, MOS6507_REG_A, 1))
+IMPLIED_INSTRUCTION(0x98, transfer(cpu, MOS6507_REG_Y, MOS6507_REG_A, 1))
+
+/* Stack */
+IMPLIED_INSTRUCTION(0xBA, transfer(cpu, MOS6507_REG_S, MOS6507_REG_X, 1))
+IMPLIED_INSTRUCTION(0x9A, transfer(cpu, MOS6507_REG_X, MOS6507_REG_S, 0))
+
+INSTRUCTION_HANDLER instruction_0x48(atari2600_t *atari, uint16_t operand)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t A;
+    mos6507_get_register(cpu, MOS6507_REG_A, &A);
+    bus_push(atari, 2, A);
+    return 3;
+}
+
+INSTRUCTION_HANDLER instruction_0x08(atari2600_t *atari, uint16_t operand)
+{
+    mos6507 *cpu = &atari->cpu;
+    /* The break flag and unused bit 5 always read as set when pushed */
+    uint8_t P;
+    mos6507_get_register(cpu, MOS6507_REG_P, &P);
+    bus_push(atari, 2, P | MOS6507_STATUS_FLAG_BREAK | 0x20);
+    return 3;
+}
+
+INSTRUCTION_HANDLER instruction_0x68(atari2600_t *atari, uint16_t operand)
+{
+    mos6507 *cpu = &atari->cpu;
+    load_A(cpu, bus_pull(atari, 3));
+    return 4;
+}
+
+INSTRUCTION_HANDLER instruction_0x28(atari2600_t *atari, uint16_t operand)
+{
+    mos6507 *cpu = &atari->cpu;
+    mos6507_set_register(cpu, MOS6507_REG_P, bus_pull(atari, 3) & ~(MOS6507_STATUS_FLAG_BREAK | 0x20));
+    return 4;
+}
+
+/* Subroutine */
+INSTRUCTION_HANDLER instruction_0x20(atari2600_t *atari, uint16_t operand)
+{
+    mos6507 *cpu = &atari->cpu;
+    /* The return address pushed is that of the last byte of the JSR */
+    uint16_t pc = mos6507_get_PC(cpu) - 1;
+    bus_push(atari, 3, (uint8_t)(pc >> 8));
+    bus_push(atari, 4, (uint8_t)pc);
+    mos6507_set_PC(cpu, operand);
+    return 6;
+}
+
+INSTRUCTION_HANDLER instruction_0x60(atari2600_t *atari, uint16_t operand)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t pcl = bus_pull(atari, 3);
+    uint8_t pch = bus_pull(atari, 4);
+    mos6507_set_PC_hl(cpu, pch, pcl);
+    mos6507_increment_PC(cpu);
+    return 6;
+}
+
+INSTRUCTION_HANDLER instruction_0x40(atari2600_t *atari, uint16_t operand)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t P = bus_pull(atari, 3);
+    uint8_t pcl = bus_pull(atari, 4);
+    uint8_t pch = bus_pull(atari, 5);
+    mos6507_set_register(cpu, MOS6507_REG_P, P & ~(MOS6507_STATUS_FLAG_BREAK | 0x20));
+    mos6507_set_PC_hl(cpu, pch, pcl);
+    return 6;
+}
+
+/* Set and reset */
+IMPLIED_INSTRUCTION(0x18, cpu->C = 0)
+IMPLIED_INSTRUCTION(0xD8, mos6507_set_status_flag(cpu, MOS6507_STATUS_FLAG_DECIMAL, 0))
+IMPLIED_INSTRUCTION(0x58, mos6507_set_status_flag(cpu, MOS6507_STATUS_FLAG_INTERRUPT, 0))
+IMPLIED_INSTRUCTION(0xB8, cpu->V = 0)
+IMPLIED_INSTRUCTION(0x38, cpu->C = 1)
+IMPLIED_INSTRUCTION(0xF8, mos6507_set_status_flag(cpu, MOS6507_STATUS_FLAG_DECIMAL, 1))
+IMPLIED_INSTRUCTION(0x78, mos6507_set_status_flag(cpu, MOS6507_STATUS_FLAG_INTERRUPT, 1))
+
+/* Miscellaneous */
+IMPLIED_INSTRUCTION(0xEA, nop(cpu, 0))
+
+INSTRUCTION_HANDLER instruction_0x00(atari2600_t *atari, uint16_t operand)
+{
+    mos6507 *cpu = &atari->cpu;
+    /* BRK skips the padding byte which follows it */
+    uint8_t P, adl, adh;
+    uint16_t pc = mos6507_get_PC(cpu) + 1;
+    mos6507_get_register(cpu, MOS6507_REG_P, &P);
+    bus_push(atari, 2, (uint8_t)(pc >> 8));
+    bus_push(atari, 3, (uint8_t)pc);
+    bus_push(atari, 4, P | MOS6507_STATUS_FLAG_BREAK | 0x20);
+    mos6507_set_status_flag(cpu, MOS6507_STATUS_FLAG_INTERRUPT, 1);
+    adl = bus_read(atari, 0xFFFE, 5);
+    adh = bus_read(atari, 0xFFFF, 6);
+    mos6507_set_PC_hl(cpu, adh, adl);
+    return 7;
+}
+
+/******************************************************************************
+ * Undocumented instructions
+ *****************************************************************************/
+
+/* Read-modify-write combined with an ALU operation */
+MODIFY_INSTRUCTION(0x03, INDIRECT_X_INDEXED, mos6507_SLO)
+MODIFY_INSTRUCTION(0x07, ZERO_PAGE, mos6507_SLO)
+MODIFY_INSTRUCTION(0x0F, ABSOLUTE, mos6507_SLO)
+MODIFY_INSTRUCTION(0x13, INDIRECT_Y_INDEXED, mos6507_SLO)
+MODIFY_INSTRUCTION(0x17, ZERO_PAGE_X_INDEXED, mos6507_SLO)
+MODIFY_INSTRUCTION(0x1B, ABSOLUTE_Y_INDEXED, mos6507_SLO)
+MODIFY_INSTRUCTION(0x1F, ABSOLUTE_X_INDEXED, mos6507_SLO)
+
+MODIFY_INSTRUCTION(0x23, INDIRECT_X_INDEXED, mos6507_RLA)
+MODIFY_INSTRUCTION(0x27, ZERO_PAGE, mos6507_RLA)
+MODIFY_INSTRUCTION(0x2F, ABSOLUTE, mos6507_RLA)
+MODIFY_INSTRUCTION(0x33, INDIRECT_Y_INDEXED, mos6507_RLA)
+MODIFY_INSTRUCTION(0x37, ZERO_PAGE_X_INDEXED, mos6507_RLA)
+MODIFY_INSTRUCTION(0x3B, ABSOLUTE_Y_INDEXED, mos6507_RLA)
+MODIFY_INSTRUCTION(0x3F, ABSOLUTE_X_INDEXED, mos6507_RLA)
+
+MODIFY_INSTRUCTION(0x43, INDIRECT_X_INDEXED, mos6507_SRE)
+MODIFY_INSTRUCTION(0x47, ZERO_PAGE, mos6507_SRE)
+MODIFY_INSTRUCTION(0x4F, ABSOLUTE, mos6507_SRE)
+MODIFY_INSTRUCTION(0x53, INDIRECT_Y_INDEXED, mos6507_SRE)
+MODIFY_INSTRUCTION(0x57, ZERO_PAGE_X_INDEXED, mos6507_SRE)
+MODIFY_INSTRUCTION(0x5B, ABSOLUTE_Y_INDEXED, mos6507_SRE)
+MODIFY_INSTRUCTION(0x5F, ABSOLUTE_X_INDEXED, mos6507_SRE)
+
+MODIFY_INSTRUCTION(0x63, INDIRECT_X_INDEXED, mos6507_RRA)
+MODIFY_INSTRUCTION(0x67, ZERO_PAGE, mos6507_RRA)
+MODIFY_INSTRUCTION(0x6F, ABSOLUTE, mos6507_RRA)
+MODIFY_INSTRUCTION(0x73, INDIRECT_Y_INDEXED, mos6507_RRA)
+MODIFY_INSTRUCTION(0x77, ZERO_PAGE_X_INDEXED, mos6507_RRA)
+MODIFY_INSTRUCTION(0x7B, ABSOLUTE_Y_INDEXED, mos6507_RRA)
+MODIFY_INSTRUCTION(0x7F, ABSOLUTE_X_INDEXED, mos6507_RRA)
+
+MODIFY_INSTRUCTION(0xC3, INDIRECT_X_INDEXED, mos6507_DCP)
+MODIFY_INSTRUCTION(0xC7, ZERO_PAGE, mos6507_DCP)
+MODIFY_INSTRUCTION(0xCF, ABSOLUTE, mos6507_DCP)
+MODIFY_INSTRUCTION(0xD3, INDIRECT_Y_INDEXED, mos6507_DCP)
+MODIFY_INSTRUCTION(0xD7, ZERO_PAGE_X_INDEXED, mos6507_DCP)
+MODIFY_INSTRUCTION(0xDB, ABSOLUTE_Y_INDEXED, mos6507_DCP)
+MODIFY_INSTRUCTION(0xDF, ABSOLUTE_X_INDEXED, mos6507_DCP)
+
+MODIFY_INSTRUCTION(0xE3, INDIRECT_X_INDEXED, mos6507_ISB)
+MODIFY_INSTRUCTION(0xE7, ZERO_PAGE, mos6507_ISB)
+MODIFY_INSTRUCTION(0xEF, ABSOLUTE, mos6507_ISB)
+MODIFY_INSTRUCTION(0xF3, INDIRECT_Y_INDEXED, mos6507_ISB)
+MODIFY_INSTRUCTION(0xF7, ZERO_PAGE_X_INDEXED, mos6507_ISB)
+MODIFY_INSTRUCTION(0xFB, ABSOLUTE_Y_INDEXED, mos6507_ISB)
+MODIFY_INSTRUCTION(0xFF, ABSOLUTE_X_INDEXED, mos6507_ISB)
+
+/* Combined load and store */
+LOAD_INSTRUCTION(0xA7, ZERO_PAGE, mos6507_LAX)
+LOAD_INSTRUCTION(0xB7, ZERO_PAGE_Y_INDEXED, mos6507_LAX)
+LOAD_INSTRUCTION(0xAF, ABSOLUTE, mos6507_LAX)
+LOAD_INSTRUCTION(0xBF, ABSOLUTE_Y_INDEXED, mos6507_LAX)
+LOAD_INSTRUCTION(0xA3, INDIRECT_X_INDEXED, mos6507_LAX)
+LOAD_INSTRUCTION(0xB3, INDIRECT_Y_INDEXED, mos6507_LAX)
+
+STORE_INSTRUCTION(0x87, ZERO_PAGE, cpu->A & cpu->X)
+STORE_INSTRUCTION(0x97, ZERO_PAGE_Y_INDEXED, cpu->A & cpu->X)
+STORE_INSTRUCTION(0x8F, ABSOLUTE, cpu->A & cpu->X)
+STORE_INSTRUCTION(0x83, INDIRECT_X_INDEXED, cpu->A & cpu->X)
+
+/* Immediate operations on the accumulator */
+IMMEDIATE_INSTRUCTION(0x0B, mos6507_ANC)
+IMMEDIATE_INSTRUCTION(0x2B, mos6507_ANC)
+IMMEDIATE_INSTRUCTION(0x4B, mos6507_ALR)
+IMMEDIATE_INSTRUCTION(0x6B, mos6507_ARR)
+IMMEDIATE_INSTRUCTION(0xCB, mos6507_SBX)
+IMMEDIATE_INSTRUCTION(0xEB, mos6507_SBC)
+
+/* NOPs, which still perform the read of their addressing mode */
+IMPLIED_INSTRUCTION(0x1A, nop(cpu, 0))
+IMPLIED_INSTRUCTION(0x3A, nop(cpu, 0))
+IMPLIED_INSTRUCTION(0x5A, nop(cpu, 0))
+IMPLIED_INSTRUCTION(0x7A, nop(cpu, 0))
+IMPLIED_INSTRUCTION(0xDA, nop(cpu, 0))
+IMPLIED_INSTRUCTION(0xFA, nop(cpu, 0))
+IMMEDIATE_INSTRUCTION(0x80, nop)
+IMMEDIATE_INSTRUCTION(0x82, nop)
+IMMEDIATE_INSTRUCTION(0x89, nop)
+IMMEDIATE_INSTRUCTION(0xC2, nop)
+IMMEDIATE_INSTRUCTION(0xE2, nop)
+LOAD_INSTRUCTION(0x04, ZERO_PAGE, nop)
+LOAD_INSTRUCTION(0x44, ZERO_PAGE, nop)
+LOAD_INSTRUCTION(0x64, ZERO_PAGE, nop)
+LOAD_INSTRUCTION(0x14, ZERO_PAGE_X_INDEXED, nop)
+LOAD_INSTRUCTION(0x34, ZERO_PAGE_X_INDEXED, nop)
+LOAD_INSTRUCTION(0x54, ZERO_PAGE_X_INDEXED, nop)
+LOAD_INSTRUCTION(0x74, ZERO_PAGE_X_INDEXED, nop)
+LOAD_INSTRUCTION(0xD4, ZERO_PAGE_X_INDEXED, nop)
+LOAD_INSTRUCTION(0xF4, ZERO_PAGE_X_INDEXED, nop)
+LOAD_INSTRUCTION(0x0C, ABSOLUTE, nop)
+LOAD_INSTRUCTION(0x1C, ABSOLUTE_X_INDEXED, nop)
+LOAD_INSTRUCTION(0x3C, ABSOLUTE_X_INDEXED, nop)
+LOAD_INSTRUCTION(0x5C, ABSOLUTE_X_INDEXED, nop)
+LOAD_INSTRUCTION(0x7C, ABSOLUTE_X_INDEXED, nop)
+LOAD_INSTRUCTION(0xDC, ABSOLUTE_X_INDEXED, nop)
+LOAD_INSTRUCTION(0xFC, ABSOLUTE_X_INDEXED, nop)
+
+/* Unstable, depending on the chip's analogue behaviour */
+IMMEDIATE_INSTRUCTION(0x8B, mos6507_ANE)
+IMMEDIATE_INSTRUCTION(0xAB, mos6507_LXA)
+LOAD_INSTRUCTION(0xBB, ABSOLUTE_Y_INDEXED, mos6507_LAS)
+STORE_HIGH_INSTRUCTION(0x93, INDIRECT_Y_INDEXED, cpu->A & cpu->X)
+STORE_HIGH_INSTRUCTION(0x9F, ABSOLUTE_Y_INDEXED, cpu->A & cpu->X)
+STORE_HIGH_INSTRUCTION(0x9B, ABSOLUTE_Y_INDEXED, cpu->S = cpu->A & cpu->X)
+STORE_HIGH_INSTRUCTION(0x9C, ABSOLUTE_X_INDEXED, cpu->Y)
+STORE_HIGH_INSTRUCTION(0x9E, ABSOLUTE_Y_INDEXED, cpu->X)
+
+/* JAM locks the CPU up until it is reset. The program counter is left on
+ * the op-code and the caller is told it has stopped.
+ */
+#define JAM_INSTRUCTION(_opcode) \
+    INSTRUCTION_HANDLER instruction_##_opcode(atari2600_t *atari, uint16_t operand) \
+    { \
+        mos6507 *cpu = &atari->cpu; \
+        mos6507_set_PC(cpu, mos6507_get_PC(cpu) - 1); \
+        return -1; \
+    }
+
+JAM_INSTRUCTION(0x02)
+JAM_INSTRUCTION(0x12)
+JAM_INSTRUCTION(0x22)
+JAM_INSTRUCTION(0x32)
+JAM_INSTRUCTION(0x42)
+JAM_INSTRUCTION(0x52)
+JAM_INSTRUCTION(0x62)
+JAM_INSTRUCTION(0x72)
+JAM_INSTRUCTION(0x92)
+JAM_INSTRUCTION(0xB2)
+JAM_INSTRUCTION(0xD2)
+JAM_INSTRUCTION(0xF2)
+
+/* Every op-code has an entry, so nothing needs validating before it runs */
+const mos6507_instruction_t mos6507_instruction_table[256] = {
+    [0xA9] = { instruction_0xA9, 2, 2 },
+    [0xA5] = { instruction_0xA5, 2, 3 },
+    [0xB5] = { instruction_0xB5, 2, 4 },
+    [0xAD] = { instruction_0xAD, 3, 4 },
+    [0xBD] = { instruction_0xBD, 3, 4 },
+    [0xB9] = { instruction_0xB9, 3, 4 },
+    [0xA1] = { instruction_0xA1, 2, 6 },
+    [0xB1] = { instruction_0xB1, 2, 5 },
+
+    [0xA2] = { instruction_0xA2, 2, 2 },
+    [0xA6] = { instruction_0xA6, 2, 3 },
+    [0xB6] = { instruction_0xB6, 2, 4 },
+    [0xAE] = { instruction_0xAE, 3, 4 },
+    [0xBE] = { instruction_0xBE, 3, 4 },
+
+    [0xA0] = { instruction_0xA0, 2, 2 },
+    [0xA4] = { instruction_0xA4, 2, 3 },
+    [0xB4] = { instruction_0xB4, 2, 4 },
+    [0xAC] = { instruction_0xAC, 3, 4 },
+    [0xBC] = { instruction_0xBC, 3, 4 },
+
+    [0x85] = { instruction_0x85, 2, 3 },
+    [0x95] = { instruction_0x95, 2, 4 },
+    [0x8D] = { instruction_0x8D, 3, 4 },
+    [0x9D] = { instruction_0x9D, 3, 5 },
+    [0x99] = { instruction_0x99, 3, 5 },
+    [0x81] = { instruction_0x81, 2, 6 },
+    [0x91] = { instruction_0x91, 2, 6 },
+
+    [0x86] = { instruction_0x86, 2, 3 },
+    [0x96] = { instruction_0x96, 2, 4 },
+    [0x8E] = { instruction_0x8E, 3, 4 },
+
+    [0x84] = { instruction_0x84, 2, 3 },
+    [0x94] = { instruction_0x94, 2, 4 },
+    [0x8C] = { instruction_0x8C, 3, 4 },
+
+    [0x69] = { instruction_0x69, 2, 2 },
+    [0x65] = { instruction_0x65, 2, 3 },
+    [0x75] = { instruction_0x75, 2, 4 },
+    [0x6D] = { instruction_0x6D, 3, 4 },
+    [0x7D] = { instruction_0x7D, 3, 4 },
+    [0x79] = { instruction_0x79, 3, 4 },
+    [0x61] = { instruction_0x61, 2, 6 },
+    [0x71] = { instruction_0x71, 2, 5 },
+
+    [0xE9] = { instruction_0xE9, 2, 2 },
+    [0xE5] = { instruction_0xE5, 2, 3 },
+    [0xF5] = { instruction_0xF5, 2, 4 },
+    [0xED] = { instruction_0xED, 3, 4 },
+    [0xFD] = { instruction_0xFD, 3, 4 },
+    [0xF9] = { instruction_0xF9, 3, 4 },
+    [0xE1] = { instruction_0xE1, 2, 6 },
+    [0xF1] = { instruction_0xF1, 2, 5 },
+
+    [0xE6] = { instruction_0xE6, 2, 5 },
+    [0xF6] = { instruction_0xF6, 2, 6 },
+    [0xEE] = { instruction_0xEE, 3, 6 },
+    [0xFE] = { instruction_0xFE, 3, 7 },
+    [0xE8] = { instruction_0xE8, 1, 2 },
+    [0xC8] = { instruction_0xC8, 1, 2 },
+
+    [0xC6] = { instruction_0xC6, 2, 5 },
+    [0xD6] = { instruction_0xD6, 2, 6 },
+    [0xCE] = { instruction_0xCE, 3, 6 },
+    [0xDE] = { instruction_0xDE, 3, 7 },
+    [0xCA] = { instruction_0xCA, 1, 2 },
+    [0x88] = { instruction_0x88, 1, 2 },
+
+    [0x29] = { instruction_0x29, 2, 2 },
+    [0x25] = { instruction_0x25, 2, 3 },
+    [0x35] = { instruction_0x35, 2, 4 },
+    [0x2D] = { instruction_0x2D, 3, 4 },
+    [0x3D] = { instruction_0x3D, 3, 4 },
+    [0x39] = { instruction_0x39, 3, 4 },
+    [0x21] = { instruction_0x21, 2, 6 },
+    [0x31] = { instruction_0x31, 2, 5 },
+
+    [0x09] = { instruction_0x09, 2, 2 },
+    [0x05] = { instruction_0x05, 2, 3 },
+    [0x15] = { instruction_0x15, 2, 4 },
+    [0x0D] = { instruction_0x0D, 3, 4 },
+    [0x1D] = { instruction_0x1D, 3, 4 },
+    [0x19] = { instruction_0x19, 3, 4 },
+    [0x01] = { instruction_0x01, 2, 6 },
+    [0x11] = { instruction_0x11, 2, 5 },
+
+    [0x49] = { instruction_0x49, 2, 2 },
+    [0x45] = { instruction_0x45, 2, 3 },
+    [0x55] = { instruction_0x55, 2, 4 },
+    [0x4D] = { instruction_0x4D, 3, 4 },
+    [0x5D] = { instruction_0x5D, 3, 4 },
+    [0x59] = { instruction_0x59, 3, 4 },
+    [0x41] = { instruction_0x41, 2, 6 },
+    [0x51] = { instruction_0x51, 2, 5 },
+
+    [0x4C] = { instruction_0x4C, 3, 3 },
+    [0x6C] = { instruction_0x6C, 3, 5 },
+
+    [0x90] = { instruction_0x90, 2, 2 },
+    [0xB0] = { instruction_0xB0, 2, 2 },
+    [0xF0] = { instruction_0xF0, 2, 2 },
+    [0xD0] = { instruction_0xD0, 2, 2 },
+    [0x30] = { instruction_0x30, 2, 2 },
+    [0x10] = { instruction_0x10, 2, 2 },
+    [0x70] = { instruction_0x70, 2, 2 },
+    [0x50] = { instruction_0x50, 2, 2 },
+
+    [0xC9] = { instruction_0xC9, 2, 2 },
+    [0xC5] = { instruction_0xC5, 2, 3 },
+    [0xD5] = { instruction_0xD5, 2, 4 },
+    [0xCD] = { instruction_0xCD, 3, 4 },
+    [0xDD] = { instruction_0xDD, 3, 4 },
+    [0xD9] = { instruction_0xD9, 3, 4 },
+    [0xC1] = { instruction_0xC1, 2, 6 },
+    [0xD1] = { instruction_0xD1, 2, 5 },
+
+    [0xE0] = { instruction_0xE0, 2, 2 },
+    [0xE4] = { instruction_0xE4, 2, 3 },
+    [0xEC] = { instruction_0xEC, 3, 4 },
+
+    [0xC0] = { instruction_0xC0, 2, 2 },
+    [0xC4] = { instruction_0xC4, 2, 3 },
+    [0xCC] = { instruction_0xCC, 3, 4 },
+
+    [0x24] = { instruction_0x24, 2, 3 },
+    [0x2C] = { instruction_0x2C, 3, 4 },
+
+    [0x0A] = { instruction_0x0A, 1, 2 },
+    [0x06] = { instruction_0x06, 2, 5 },
+    [0x16] = { instruction_0x16, 2, 6 },
+    [0x0E] = { instruction_0x0E, 3, 6 },
+    [0x1E] = { instruction_0x1E, 3, 7 },
+
+    [0x4A] = { instruction_0x4A, 1, 2 },
+    [0x46] = { instruction_0x46, 2, 5 },
+    [0x56] = { instruction_0x56, 2, 6 },
+    [0x4E] = { instruction_0x4E, 3, 6 },
+    [0x5E] = { instruction_0x5E, 3, 7 },
+
+    [0x2A] = { instruction_0x2A, 1, 2 },
+    [0x26] = { instruction_0x26, 2, 5 },
+    [0x36] = { instruction_0x36, 2, 6 },
+    [0x2E] = { instruction_0x2E, 3, 6 },
+    [0x3E] = { instruction_0x3E, 3, 7 },
+
+    [0x6A] = { instruction_0x6A, 1, 2 },
+    [0x66] = { instruction_0x66, 2, 5 },
+    [0x76] = { instruction_0x76, 2, 6 },
+    [0x6E] = { instruction_0x6E, 3, 6 },
+    [0x7E] = { instruction_0x7E, 3, 7 },
+
+    [0xAA] = { instruction_0xAA, 1, 2 },
+    [0xA8] = { instruction_0xA8, 1, 2 },
+    [0x8A] = { instruction_0x8A, 1, 2 },
+    [0x98] = { instruction_0x98, 1, 2 },
+
+    [0xBA] = { instruction_0xBA, 1, 2 },
+    [0x9A] = { instruction_0x9A, 1, 2 },
+    [0x48] = { instruction_0x48, 1, 3 },
+    [0x08] = { instruction_0x08, 1, 3 },
+    [0x68] = { instruction_0x68, 1, 4 },
+    [0x28] = { instruction_0x28, 1, 4 },
+
+    [0x20] = { instruction_0x20, 3, 6 },
+    [0x60] = { instruction_0x60, 1, 6 },
+    [0x40] = { instruction_0x40, 1, 6 },
+
+    [0x18] = { instruction_0x18, 1, 2 },
+    [0xD8] = { instruction_0xD8, 1, 2 },
+    [0x58] = { instruction_0x58, 1, 2 },
+    [0xB8] = { instruction_0xB8, 1, 2 },
+    [0x38] = { instruction_0x38, 1, 2 },
+    [0xF8] = { instruction_0xF8, 1, 2 },
+    [0x78] = { instruction_0x78, 1, 2 },
+
+    [0xEA] = { instruction_0xEA, 1, 2 },
+    [0x00] = { instruction_0x00, 1, 7 },
+
+    [0x03] = { instruction_0x03, 2, 8 },
+    [0x07] = { instruction_0x07, 2, 5 },
+    [0x0F] = { instruction_0x0F, 3, 6 },
+    [0x13] = { instruction_0x13, 2, 8 },
+    [0x17] = { instruction_0x17, 2, 6 },
+    [0x1B] = { instruction_0x1B, 3, 7 },
+    [0x1F] = { instruction_0x1F, 3, 7 },
+
+    [0x23] = { instruction_0x23, 2, 8 },
+    [0x27] = { instruction_0x27, 2, 5 },
+    [0x2F] = { instruction_0x2F, 3, 6 },
+    [0x33] = { instruction_0x33, 2, 8 },
+    [0x37] = { instruction_0x37, 2, 6 },
+    [0x3B] = { instruction_0x3B, 3, 7 },
+    [0x3F] = { instruction_0x3F, 3, 7 },
+
+    [0x43] = { instruction_0x43, 2, 8 },
+    [0x47] = { instruction_0x47, 2, 5 },
+    [0x4F] = { instruction_0x4F, 3, 6 },
+    [0x53] = { instruction_0x53, 2, 8 },
+    [0x57] = { instruction_0x57, 2, 6 },
+    [0x5B] = { instruction_0x5B, 3, 7 },
+    [0x5F] = { instruction_0x5F, 3, 7 },
+
+    [0x63] = { instruction_0x63, 2, 8 },
+    [0x67] = { instruction_0x67, 2, 5 },
+    [0x6F] = { instruction_0x6F, 3, 6 },
+    [0x73] = { instruction_0x73, 2, 8 },
+    [0x77] = { instruction_0x77, 2, 6 },
+    [0x7B] = { instruction_0x7B, 3, 7 },
+    [0x7F] = { instruction_0x7F, 3, 7 },
+
+    [0xC3] = { instruction_0xC3, 2, 8 },
+    [0xC7] = { instruction_0xC7, 2, 5 },
+    [0xCF] = { instruction_0xCF, 3, 6 },
+    [0xD3] = { instruction_0xD3, 2, 8 },
+    [0xD7] = { instruction_0xD7, 2, 6 },
+    [0xDB] = { instruction_0xDB, 3, 7 },
+    [0xDF] = { instruction_0xDF, 3, 7 },
+
+    [0xE3] = { instruction_0xE3, 2, 8 },
+    [0xE7] = { instruction_0xE7, 2, 5 },
+    [0xEF] = { instruction_0xEF, 3, 6 },
+    [0xF3] = { instruction_0xF3, 2, 8 },
+    [0xF7] = { instruction_0xF7, 2, 6 },
+    [0xFB] = { instruction_0xFB, 3, 7 },
+    [0xFF] = { instruction_0xFF, 3, 7 },
+
+    [0xA7] = { instruction_0xA7, 2, 3 },
+    [0xB7] = { instruction_0xB7, 2, 4 },
+    [0xAF] = { instruction_0xAF, 3, 4 },
+    [0xBF] = { instruction_0xBF, 3, 4 },
+    [0xA3] = { instruction_0xA3, 2, 6 },
+    [0xB3] = { instruction_0xB3, 2, 5 },
+
+    [0x87] = { instruction_0x87, 2, 3 },
+    [0x97] = { instruction_0x97, 2, 4 },
+    [0x8F] = { instruction_0x8F, 3, 4 },
+    [0x83] = { instruction_0x83, 2, 6 },
+
+    [0x0B] = { instruction_0x0B, 2, 2 },
+    [0x2B] = { instruction_0x2B, 2, 2 },
+    [0x4B] = { instruction_0x4B, 2, 2 },
+    [0x6B] = { instruction_0x6B, 2, 2 },
+    [0xCB] = { instruction_0xCB, 2, 2 },
+    [0xEB] = { instruction_0xEB, 2, 2 },
+
+    [0x1A] = { instruction_0x1A, 1, 2 },
+    [0x3A] = { instruction_0x3A, 1, 2 },
+    [0x5A] = { instruction_0x5A, 1, 2 },
+    [0x7A] = { instruction_0x7A, 1, 2 },
+    [0xDA] = { instruction_0xDA, 1, 2 },
+    [0xFA] = { instruction_0xFA, 1, 2 },
+    [0x80] = { instruction_0x80, 2, 2 },
+    [0x82] = { instruction_0x82, 2, 2 },
+    [0x89] = { instruction_0x89, 2, 2 },
+    [0xC2] = { instruction_0xC2, 2, 2 },
+    [0xE2] = { instruction_0xE2, 2, 2 },
+    [0x04] = { instruction_0x04, 2, 3 },
+    [0x44] = { instruction_0x44, 2, 3 },
+    [0x64] = { instruction_0x64, 2, 3 },
+    [0x14] = { instruction_0x14, 2, 4 },
+    [0x34] = { instruction_0x34, 2, 4 },
+    [0x54] = { instruction_0x54, 2, 4 },
+    [0x74] = { instruction_0x74, 2, 4 },
+    [0xD4] = { instruction_0xD4, 2, 4 },
+    [0xF4] = { instruction_0xF4, 2, 4 },
+    [0x0C] = { instruction_0x0C, 3, 4 },
+    [0x1C] = { instruction_0x1C, 3, 4 },
+    [0x3C] = { instruction_0x3C, 3, 4 },
+    [0x5C] = { instruction_0x5C, 3, 4 },
+    [0x7C] = { instruction_0x7C, 3, 4 },
+    [0xDC] = { instruction_0xDC, 3, 4 },
+    [0xFC] = { instruction_0xFC, 3, 4 },
+
+    [0x8B] = { instruction_0x8B, 2, 2 },
+    [0xAB] = { instruction_0xAB, 2, 2 },
+    [0xBB] = { instruction_0xBB, 3, 4 },
+    [0x93] = { instruction_0x93, 2, 6 },
+    [0x9F] = { instruction_0x9F, 3, 5 },
+    [0x9B] = { instruction_0x9B, 3, 5 },
+    [0x9C] = { instruction_0x9C, 3, 5 },
+    [0x9E] = { instruction_0x9E, 3, 5 },
+
+    [0x02] = { instruction_0x02, 1, 2 },
+    [0x12] = { instruction_0x12, 1, 2 },
+    [0x22] = { instruction_0x22, 1, 2 },
+    [0x32] = { instruction_0x32, 1, 2 },
+    [0x42] = { instruction_0x42, 1, 2 },
+    [0x52] = { instruction_0x52, 1, 2 },
+    [0x62] = { instruction_0x62, 1, 2 },
+    [0x72] = { instruction_0x72, 1, 2 },
+    [0x92] = { instruction_0x92, 1, 2 },
+    [0xB2] = { instruction_0xB2, 1, 2 },
+    [0xD2] = { instruction_0xD2, 1, 2 },
+    [0xF2] = { instruction_0xF2, 1, 2 },
+};
+
+/******************************************************************************
+ * Fused pairs
+ *
+ * Kernels spend most of their time in a handful of two instruction
+ * sequences, mostly a store to WSYNC followed by whatever starts the next
+ * line. Each pair below runs from a single handler, with the second
+ * instruction's bus accesses stamped after the cycles of the first, so it
+ * costs one dispatch and one catch up of the console instead of two.
+ *
+ * The pairs are the most frequent ones across the test cartridges. Both
+ * instructions have at most one operand byte, so the two pack into the
+ * decoded entry, and the second never reads the bus.
+ *****************************************************************************/
+
+#if MOS6507_CORE_INSTRUCTION && MOS6507_FUSION
+
+/* First op-code, second op-code, length of both */
+#define FUSED_PAIRS(X) \
+    X(0x85, 0x85, 4) /* STA zp; STA zp, e.g. WSYNC then a colour */ \
+    X(0x85, 0xA9, 4) /* STA zp; LDA #imm */ \
+    X(0x85, 0xCA, 3) /* STA zp; DEX, usually WSYNC */ \
+    X(0x85, 0x88, 3) /* STA zp; DEY, usually WSYNC */ \
+    X(0x85, 0xE8, 3) /* STA zp; INX, usually WSYNC */ \
+    X(0xA9, 0x85, 4) /* LDA #imm; STA zp */ \
+    X(0xB1, 0x85, 4) /* LDA (zp),Y; STA GRPx */ \
+    X(0xCA, 0xD0, 3) /* DEX; BNE */ \
+    X(0x88, 0xD0, 3) /* DEY; BNE */
+
+#define FUSED_KIND(_first, _second, _length) FUSED_##_first##_##_second,
+enum {
+    FUSED_NONE = 0,
+    FUSED_PAIRS(FUSED_KIND)
+    FUSED_COUNT
+};
+
+/* The second instruction of a pair, with any bus access landing base
+ * cycles after the start of the pair
+ */
+#define FUSED_SECOND(_opcode) \
+    INSTRUCTION_HANDLER fused_second_##_opcode(atari2600_t *atari, uint8_t operand, int base) \
+    { \
+        return instruction_##_opcode(atari, operand); \
+    }
+
+#define FUSED_SECOND_STORE(_opcode, _value) \
+    INSTRUCTION_HANDLER fused_second_##_opcode(atari2600_t *atari, uint8_t operand, int base) \
+    { \
+        mos6507 *cpu = &atari->cpu; \
+        bus_write(atari, operand, base + STORE_CYCLES_ZERO_PAGE - 1, (_value)); \
+        return STORE_CYCLES_ZERO_PAGE; \
+    }
+
+FUSED_SECOND_STORE(0x85, cpu->A)
+FUSED_SECOND(0x88)
+FUSED_SECOND(0xA9)
+FUSED_SECOND(0xCA)
+FUSED_SECOND(0xD0)
+FUSED_SECOND(0xE8)
+
+/* The operand holds the first instruction's operand byte in its low byte
+ * and the second's in its high byte
+ */
+#define FUSED_HANDLER(_first, _second, _length) \
+    INSTRUCTION_HANDLER fused_##_first##_##_second(atari2600_t *atari, uint16_t operand) \
+    { \
+        int cycles = instruction_##_first(atari, operand & 0xFF); \
+        return cycles + fused_second_##_second(atari, operand >> 8, cycles); \
+    }
+
+FUSED_PAIRS(FUSED_HANDLER)
+
+typedef struct {
+    mos6507_instruction_fp execute;
+    uint8_t first;
+    uint8_t second;
+    uint8_t length;
+} fused_pair_t;
+
+#define FUSED_ENTRY(_first, _second, _length) \
+    [FUSED_##_first##_##_second] = { fused_##_first##_##_second, _first, _second, _length },
+
+static const fused_pair_t fused_pairs[FUSED_COUNT] = {
+    FUSED_PAIRS(FUSED_ENTRY)
+};
+#endif /* MOS6507_CORE_INSTRUCTION && MOS6507_FUSION */
+
+/******************************************************************************
+ * Decode cache
+ *****************************************************************************/
+
+#if MOS6507_CORE_INSTRUCTION
+
+/* Reads a byte the decoder can rely on staying put, without going near the
+ * bus. Returns -1 unless the address is directly mapped cartridge memory.
+ */
+static inline int decode_peek(atari2600_t *atari, uint16_t address)
+{
+    const memmap_page_t *page;
+
+    address &= MEMMAP_ADDRESS_MASK;
+    if (!(address & MEMMAP_SELECT_CART)) {
+        return -1;
+    }
+    page = &atari->pages[address >> MEMMAP_PAGE_SHIFT];
+    if (!page->read) {
+        return -1;
+    }
+    return page->read[address & MEMMAP_PAGE_MASK];
+}
+
+/* Whether a read of address returns a value that changes by itself, but
+ * only as time passes: the RIOT timer, or the TIA's input ports which only
+ * change between scanlines.
+ */
+static inline int decode_is_poll_source(uint16_t address)
+{
+    address &= MEMMAP_ADDRESS_MASK;
+    if (address & MEMMAP_SELECT_CART) {
+        return 0;
+    }
+    if (address & MEMMAP_SELECT_RIOT) {
+        return (address & MEMMAP_SELECT_RIOT_IO) && (address & MOS6532_SELECT_TIMER);
+    }
+    address &= MEMMAP_TIA_READ_MASK;
+    return address >= TIA_READ_REG_INPT0 && address <= TIA_READ_REG_INPT5;
+}
+
+/* Whether the instruction at pc, with the given op-code and operand, loads
+ * from a poll source and is followed by a branch straight back to it, e.g.
+ *
+ *     wait: lda INTIM
+ *           bne wait
+ *
+ * Nothing but time changes from one trip around such a loop to the next.
+ */
+static int decode_is_poll(atari2600_t *atari, uint16_t pc, uint8_t opcode, uint16_t operand)
+{
+    int branch, offset;
+    uint16_t next;
+
+    switch (opcode) {
+        case 0xA5: case 0xA6: case 0xA4: case 0x24:
+            operand &= 0xFF;
+            break;
+        case 0xAD: case 0xAE: case 0xAC: case 0x2C:
+            break;
+        default:
+            return 0;
+    }
+    if (!decode_is_poll_source(operand)) {
+        return 0;
+    }
+
+    next = pc + mos6507_instruction_table[opcode].length;
+    if ((branch = decode_peek(atari, next)) < 0 || (offset = decode_peek(atari, next + 1)) < 0) {
+        return 0;
+    }
+    switch (branch) {
+        case 0x10: case 0x30: case 0xD0: case 0xF0:
+            break;
+        case 0x50: case 0x70:
+            /* Only BIT sets the overflow flag */
+            if (opcode != 0x24 && opcode != 0x2C) {
+                return 0;
+            }
+            break;
+        default:
+            return 0;
+    }
+    return (uint16_t)(next + 2 + (int8_t)offset) == pc;
+}
+
+#if MOS6507_FUSION
+/* Whether the instruction at pc, with the given op-code, starts one of the
+ * fused pairs. If so the second instruction's operand byte is added to
+ * operand and the kind of pair is returned, otherwise FUSED_NONE.
+ */
+static int decode_fused(atari2600_t *atari, uint16_t pc, uint8_t opcode, uint16_t *operand)
+{
+    uint16_t next = pc + mos6507_instruction_table[opcode].length;
+    int kind, second, adl = 0;
+
+    if ((second = decode_peek(atari, next)) < 0) {
+        return FUSED_NONE;
+    }
+    for (kind = FUSED_NONE + 1; kind < FUSED_COUNT; kind++) {
+        if (fused_pairs[kind].first == opcode && fused_pairs[kind].second == second) {
+            break;
+        }
+    }
+    if (kind == FUSED_COUNT) {
+        return FUSED_NONE;
+    }
+    if (mos6507_instruction_table[second].length > 1 && (adl = decode_peek(atari, next + 1)) < 0) {
+        return FUSED_NONE;
+    }
+    *operand = (*operand & 0xFF) | (adl << 8);
+    return kind;
+}
+#endif
+
+/* Decodes the instruction at pc into entry.
+ *
+ * Returns 0 on success, -1 if it can't be cached. That covers instructions
+ * which run off the end of the cartridge, which are left to the uncached
+ * path.
+ */
+static int decode_entry(atari2600_t *atari, uint16_t pc, mos6507_decoded_t *entry)
+{
+    const mos6507_instruction_t *instruction;
+    int opcode, adl = 0, adh = 0;
+
+    entry->flags = 0;
+    opcode = decode_peek(atari, pc);
+    if (opcode < 0) {
+        return -1;
+    }
+    instruction = &mos6507_instruction_table[opcode];
+    if (instruction->length > 1 && (adl = decode_peek(atari, pc + 1)) < 0) {
+        return -1;
+    }
+    if (instruction->length > 2 && (adh = decode_peek(atari, pc + 2)) < 0) {
+        return -1;
+    }
+
+    entry->opcode = opcode;
+    entry->operand = (adh << 8) | adl;
+    entry->cycles = instruction->cycles;
+    entry->flags = instruction->length | MOS6507_DECODED_VALID;
+    entry->fused = 0;
+    if (decode_is_poll(atari, pc, opcode, entry->operand)) {
+        entry->flags |= MOS6507_DECODED_POLL;
+    }
+#if MOS6507_FUSION
+    if (!(entry->flags & MOS6507_DECODED_POLL)) {
+        entry->fused = decode_fused(atari, pc, opcode, &entry->operand);
+    }
+#endif
+    return 0;
+}
+
+/* Decodes every address of the cartridge. Called whenever the memory
+ * mapped there changes, e.g. on load.
+ */
+void mos6507_decode_cache_fill(atari2600_t *atari)
+{
+    uint16_t offset;
+
+    for (offset = 0; offset < MOS6507_DECODE_CACHE_SIZE; offset++) {
+        decode_entry(atari, MEMMAP_CART_START + offset, &atari->decode_cache[offset]);
+    }
+}
+
+/* Drops any decoded instruction with a byte inside the given range, so it's
+ * decoded afresh the next time it runs.
+ */
+void mos6507_decode_cache_invalidate(atari2600_t *atari, uint16_t address, uint16_t length)
+{
+    /* Instructions starting up to two bytes earlier have operands in range,
+     * and polling loops and fused pairs look up to four bytes on
+     */
+    int start = (int)(address & MEMMAP_ADDRESS_MASK) - MEMMAP_CART_START - 4;
+    int end = start + 4 + length;
+
+    if (start < 0) {
+        start = 0;
+    }
+    if (end > MOS6507_DECODE_CACHE_SIZE) {
+        end = MOS6507_DECODE_CACHE_SIZE;
+    }
+    for (; start < end; start++) {
+        atari->decode_cache[start].flags = 0;
+    }
+}
+
+/******************************************************************************
+ * Idle loops
+ *****************************************************************************/
+
+/* The value a polling load will read the given number of cycles from now */
+static inline uint8_t idle_peek(atari2600_t *atari, uint16_t address, uint32_t ahead)
+{
+    uint8_t data = 0;
+
+    if (address & MEMMAP_SELECT_RIOT) {
+        mos6532_peek(&atari->riot, address, ahead, &data);
+    } else {
+        data = atari->tia.read_regs[address & MEMMAP_TIA_READ_MASK];
+    }
+    return data;
+}
+
+/* Whether a polling loop's branch is taken after the load reads data */
+static inline int idle_taken(uint8_t opcode, uint8_t branch, uint8_t A, uint8_t data)
+{
+    int bit = (opcode == 0x24 || opcode == 0x2C);
+    int zero = bit ? !(A & data) : !data;
+
+    switch (branch) {
+        case 0x10: return !(data & 0x80);
+        case 0x30: return (data & 0x80) != 0;
+        case 0x50: return !(data & 0x40);
+        case 0x70: return (data & 0x40) != 0;
+        case 0xD0: return !zero;
+        case 0xF0: return zero;
+    }
+    return 0;
+}
+
+/* When the CPU is about to go round a polling loop, works out how many more
+ * whole trips it will make before what it reads lets it out, without
+ * running any of them. The registers and flags are left as the last of
+ * those trips would leave them, and the PC back at the load.
+ *
+ * Returns the number of cycles the skipped trips take, which the caller
+ * must run the rest of the console through. That's never more than limit,
+ * and 0 when the CPU isn't at the top of a polling loop.
+ */
+uint32_t mos6507_idle_cycles(atari2600_t *atari, uint32_t limit)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint16_t pc = mos6507_get_PC(cpu);
+    const mos6507_decoded_t *entry;
+    uint16_t address, next;
+    uint8_t opcode, branch, A, data = 0;
+    uint32_t period, cycles;
+
+    if (!(pc & MEMMAP_SELECT_CART)) {
+        return 0;
+    }
+    entry = &atari->decode_cache[pc & (MOS6507_DECODE_CACHE_SIZE - 1)];
+    if (!(entry->flags & MOS6507_DECODED_POLL)) {
+        return 0;
+    }
+
+    opcode = entry->opcode;
+    next = pc + (entry->flags & MOS6507_DECODED_LENGTH);
+    branch = (uint8_t)decode_peek(atari, next);
+    address = (entry->flags & MOS6507_DECODED_LENGTH) == 2 ? (entry->operand & 0xFF) : entry->operand;
+    period = entry->cycles + (NOT_SAME_PAGE(next + 2, pc) ? 4 : 3);
+    mos6507_get_register(cpu, MOS6507_REG_A, &A);
+
+    /* The load reads on its last cycle */
+    for (cycles = 0; cycles + period <= limit; cycles += period) {
+        uint8_t value = idle_peek(atari, address, cycles + entry->cycles);
+        if (!idle_taken(opcode, branch, A, value)) {
+            break;
+        }
+        data = value;
+    }
+    if (!cycles) {
+        return 0;
+    }
+
+    switch (opcode) {
+        case 0xA5: case 0xAD: load_A(cpu, data); break;
+        case 0xA6: case 0xAE: load_X(cpu, data); break;
+        case 0xA4: case 0xAC: load_Y(cpu, data); break;
+        default:              mos6507_BIT(cpu, data); break;
+    }
+    return cycles;
+}
+#endif /* MOS6507_CORE_INSTRUCTION */
+
+/* Fetches, decodes and executes one complete instruction. Code in the
+ * cartridge runs straight from the decode cache, anything else (e.g. RAM)
+ * is fetched over the bus.
+ *
+ * Returns the number of cycles consumed, or -1 if the CPU has jammed.
+ */
+int mos6507_execute_instruction(atari2600_t *atari)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint16_t pc = mos6507_get_PC(cpu);
+    uint8_t adl = 0, adh = 0;
+    const mos6507_instruction_t *instruction;
+
+#if MOS6507_CORE_INSTRUCTION
+    if (pc & MEMMAP_SELECT_CART) {
+        mos6507_decoded_t *entry = &atari->decode_cache[pc & (MOS6507_DECODE_CACHE_SIZE - 1)];
+        if ((entry->flags & MOS6507_DECODED_VALID) || !decode_entry(atari, pc, entry)) {
+#if MOS6507_FUSION
+            if (entry->fused) {
+                const fused_pair_t *pair = &fused_pairs[entry->fused];
+                mos6507_set_PC(cpu, pc + pair->length);
+                return pair->execute(atari, entry->operand);
+            }
+#endif
+            mos6507_set_PC(cpu, pc + (entry->flags & MOS6507_DECODED_LENGTH));
+            return mos6507_instruction_table[entry->opcode].execute(atari, entry->operand);
+        }
+    }
+#endif
+
+    instruction = &mos6507_instruction_table[bus_read(atari, pc, 0)];
+
+    /* Operand fetches only ever touch ROM or RAM so they aren't timed */
+    if (instruction->length > 1) {
+        mos6507_set_address_bus(cpu, pc + 1);
+        memmap_read(atari, &adl);
+    }
+    if (instruction->length > 2) {
+        mos6507_set_address_bus(cpu, pc + 2);
+        memmap_read(atari, &adh);
+    }
+    mos6507_set_PC(cpu, pc + instruction->length);
+
+    return instruction->execute(atari, (adh << 8) | adl);
+}
+
+/******************************************************************************
+ * Threaded dispatch
+ *****************************************************************************/
+
+#if MOS6507_CORE_THREADED
+
+/* Labels as values are a GCC extension, which Clang also has. Defining this
+ * as 0 uses the switch instead, for comparison.
+ */
+#ifndef MOS6507_THREADED_GOTO
+    #if defined(__GNUC__)
+        #define MOS6507_THREADED_GOTO 1
+    #else
+        #define MOS6507_THREADED_GOTO 0
+    #endif
+#endif
+
+/* Expands X for every op-code */
+#define THREADED_ROW(X, _high) \
+    X(_high##0) X(_high##1) X(_high##2) X(_high##3) X(_high##4) X(_high##5) X(_high##6) X(_high##7) \
+    X(_high##8) X(_high##9) X(_high##A) X(_high##B) X(_high##C) X(_high##D) X(_high##E) X(_high##F)
+#define THREADED_OPCODES(X) \
+    THREADED_ROW(X, 0x0) THREADED_ROW(X, 0x1) THREADED_ROW(X, 0x2) THREADED_ROW(X, 0x3) \
+    THREADED_ROW(X, 0x4) THREADED_ROW(X, 0x5) THREADED_ROW(X, 0x6) THREADED_ROW(X, 0x7) \
+    THREADED_ROW(X, 0x8) THREADED_ROW(X, 0x9) THREADED_ROW(X, 0xA) THREADED_ROW(X, 0xB) \
+    THREADED_ROW(X, 0xC) THREADED_ROW(X, 0xD) THREADED_ROW(X, 0xE) THREADED_ROW(X, 0xF)
+
+/* Fused pairs are dispatched as if they were op-codes following the 256
+ * real ones
+ */
+#if MOS6507_FUSION
+#define THREADED_FUSED 0x100
+#define THREADED_PAIRS(X) FUSED_PAIRS(X)
+#define THREADED_DISPATCH_COUNT (THREADED_FUSED + FUSED_COUNT)
+#else
+#define THREADED_PAIRS(X)
+#define THREADED_DISPATCH_COUNT 0x100
+#endif
+
+/* Picks the handler for a decoded entry, moving pc past what it runs */
+static inline unsigned threaded_dispatch(const mos6507_decoded_t *entry, uint16_t *pc)
+{
+#if MOS6507_FUSION
+    if (entry->fused) {
+        *pc += fused_pairs[entry->fused].length;
+        return THREADED_FUSED + entry->fused;
+    }
+#endif
+    *pc += entry->flags & MOS6507_DECODED_LENGTH;
+    return entry->opcode;
+}
+
+/* Catches the console up with an instruction which has just run, leaving
+ * the loop once the slice is used up
+ */
+#define THREADED_RETIRE() \
+    if (cycles < 0) { \
+        return -1; \
+    } \
+    atari2600_sync(atari, cycles - 1); \
+    ran += cycles; \
+    pc = mos6507_get_PC(cpu); \
+    if (ran >= limit) { \
+        break; \
+    }
+
+#if MOS6507_THREADED_GOTO
+/* Labels as values: every handler ends by jumping straight to the next, so
+ * each gets its own prediction of what follows it. Only code which is
+ * already decoded goes that way, the rest goes back round the loop.
+ */
+#define THREADED_LABEL(_opcode) [_opcode] = &&threaded_##_opcode,
+#define THREADED_FUSED_LABEL(_first, _second, _length) \
+    [THREADED_FUSED + FUSED_##_first##_##_second] = &&threaded_##_first##_##_second,
+#define THREADED_CASE(_label, _index, _handler) \
+    _label: \
+        cycles = _handler(atari, operand); \
+        THREADED_RETIRE() \
+        entry = &cache[pc & (MOS6507_DECODE_CACHE_SIZE - 1)]; \
+        if (!(pc & MEMMAP_SELECT_CART) || !(entry->flags & MOS6507_DECODED_VALID)) { \
+            continue; \
+        } \
+        if (entry->flags & MOS6507_DECODED_POLL) { \
+            break; \
+        } \
+        atari->cycles_synced = 0; \
+        operand = entry->operand; \
+        dispatch = threaded_dispatch(entry, &pc); \
+        mos6507_set_PC(cpu, pc); \
+        goto *labels[dispatch];
+#else
+#define THREADED_CASE(_label, _index, _handler) \
+    case _index: \
+        cycles = _handler(atari, operand); \
+        break;
+#endif
+
+#define THREADED_HANDLER(_opcode) \
+    THREADED_CASE(threaded_##_opcode, _opcode, instruction_##_opcode)
+#define THREADED_FUSED_HANDLER(_first, _second, _length) \
+    THREADED_CASE(threaded_##_first##_##_second, THREADED_FUSED + FUSED_##_first##_##_second, \
+                  fused_##_first##_##_second)
+
+/* Runs instructions until at least limit cycles have passed, keeping the
+ * program counter and the decode cache in locals throughout and catching
+ * the console up after each one as atari2600_step() would. The handlers
+ * are inlined, so dispatch is a single indirect jump, or a switch where
+ * MOS6507_THREADED_GOTO is 0.
+ *
+ * The slice ends early at the top of a polling loop so the caller can skip
+ * it, see mos6507_idle_cycles().
+ *
+ * Returns the number of cycles run, or -1 if the CPU has jammed.
+ */
+int mos6507_run_threaded(atari2600_t *atari, uint32_t limit)
+{
+    mos6507 *cpu = &atari->cpu;
+    mos6507_decoded_t *cache = atari->decode_cache;
+    mos6507_decoded_t *entry;
+    uint16_t pc = mos6507_get_PC(cpu), operand;
+    unsigned dispatch;
+    uint32_t ran = 0;
+    int cycles;
+#if MOS6507_THREADED_GOTO
+    static const void *const labels[THREADED_DISPATCH_COUNT] = {
+        THREADED_OPCODES(THREADED_LABEL)
+        THREADED_PAIRS(THREADED_FUSED_LABEL)
+    };
+#endif
+
+    for (;;) {
+        atari->cycles_synced = 0;
+        entry = &cache[pc & (MOS6507_DECODE_CACHE_SIZE - 1)];
+        if ((pc & MEMMAP_SELECT_CART) && ((entry->flags & MOS6507_DECODED_VALID) || !decode_entry(atari, pc, entry))) {
+            if (ran && (entry->flags & MOS6507_DECODED_POLL)) {
+                break;
+            }
+            operand = entry->operand;
+            dispatch = threaded_dispatch(entry, &pc);
+        } else {
+            const mos6507_instruction_t *instruction;
+            uint8_t adl = 0, adh = 0;
+
+            dispatch = bus_read(atari, pc, 0);
+            instruction = &mos6507_instruction_table[dispatch];
+            if (instruction->length > 1) {
+                mos6507_set_address_bus(cpu, pc + 1);
+                memmap_read(atari, &adl);
+            }
+            if (instruction->length > 2) {
+                mos6507_set_address_bus(cpu, pc + 2);
+                memmap_read(atari, &adh);
+            }
+            operand = (adh << 8) | adl;
+            pc += instruction->length;
+        }
+        mos6507_set_PC(cpu, pc);
+
+#if MOS6507_THREADED_GOTO
+        goto *labels[dispatch];
+        THREADED_OPCODES(THREADED_HANDLER)
+        THREADED_PAIRS(THREADED_FUSED_HANDLER)
+#else
+        switch (dispatch) {
+            THREADED_OPCODES(THREADED_HANDLER)
+            THREADED_PAIRS(THREADED_FUSED_HANDLER)
+            default:
+                /* Not reached, every dispatch value has a case */
+                return -1;
+        }
+        THREADED_RETIRE()
+#endif
+    }
+    return ran;
+}
+#endif /* MOS6507_CORE_THREADED */
@@ -0,0 +1,56 @@
+/*
+ * File: mos6507-interpreter.h
+ *
+ * Instruction-level execution of the 6507. Rather than being re-entered on
+ * every clock cycle, each call runs a complete instruction and reports how
+ * many cycles it consumed. Bus accesses are stamped with the cycle they
+ * occur on so memory mapped devices can be caught up before they're touched.
+ */
+
+#ifndef _MOS6507_INTERPRETER_H
+#define _MOS6507_INTERPRETER_H
+
+#include <stdint.h>
+
+typedef struct atari2600 atari2600_t;
+
+/* Every instruction handler receives the operand bytes which follow the
+ * op-code (low byte first) and returns the number of cycles it used.
+ */
+typedef int (*mos6507_instruction_fp)(atari2600_t *atari, uint16_t operand);
+
+typedef struct {
+    mos6507_instruction_fp execute;
+    uint8_t length; /* Op-code plus operand bytes */
+    uint8_t cycles; /* Before page crossing and branch penalties */
+} mos6507_instruction_t;
+
+extern const mos6507_instruction_t mos6507_instruction_table[256];
+
+/* ROM never changes underneath the CPU, so each cartridge address is
+ * decoded once and the interpreter runs from the result. flags packs the
+ * instruction length with the bits below.
+ */
+#define MOS6507_DECODED_LENGTH 0x03 /* Op-code plus operand bytes */
+#define MOS6507_DECODED_VALID  0x08 /* Entry holds a decoded instruction */
+#define MOS6507_DECODED_POLL   0x10 /* Top of a loop polling the timer or inputs */
+
+#define MOS6507_DECODE_CACHE_SIZE 0x1000
+
+typedef struct {
+    uint16_t operand;
+    uint8_t opcode;
+    uint8_t cycles;
+    uint8_t flags;
+    uint8_t fused; /* Pair of instructions run as one, see MOS6507_FUSION */
+} mos6507_decoded_t;
+
+void mos6507_decode_cache_fill(atari2600_t *atari);
+void mos6507_decode_cache_invalidate(atari2600_t *atari, uint16_t address, uint16_t length);
+uint32_t mos6507_idle_cycles(atari2600_t *atari, uint32_t limit);
+int mos6507_execute_instruction(atari2600_t *atari);
+#if MOS6507_CORE_THREADED
+int mos6507_run_threaded(atari2600_t *atari, uint32_t limit);
+#endif
+
+#endif /* _MOS6507_INTERPRETER_H */
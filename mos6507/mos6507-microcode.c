@@ -10,6 +10,38 @@
 #include "mos6507-microcode.h"
 #include "mos6507.h"
 
+/* Decimal mode, following http://www.6502.org/tutorials/decimal_mode.html
+ *
+ * The NMOS part works out the binary result and then corrects each digit.
+ * The correction to the low digit only depends on the low nibble of the
+ * binary result and whether it carried (or borrowed) into the high nibble,
+ * so it's looked up from those five bits, as is the correction to the high
+ * digit from what's above it. This matches the real part for every input,
+ * valid BCD or not, without a chain of branches.
+ */
+static const int8_t mos6507_adc_decimal_low[32] = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   6,   6,   6,   6,   6,   6,
+      6,   6,   6,   6,   6,   6,   6,   6,   6,   6, -10, -10, -10, -10, -10, -10
+};
+
+/* Indexed by the sum, with its low digit corrected, shifted down a nibble */
+static const uint8_t mos6507_adc_decimal_high[33] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60,
+    0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60,
+    0x60
+};
+
+static const int8_t mos6507_sbc_decimal_low[32] = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+     10,  10,  10,  10,  10,  10,  -6,  -6,  -6,  -6,  -6,  -6,  -6,  -6,  -6,  -6
+};
+
+/* The high digit is corrected whenever the subtraction borrowed */
+static const uint8_t mos6507_sbc_decimal_high[2] = { 0x60, 0x00 };
+
+/* Which of the decimal tables' low entries applies to a result */
+#define DECIMAL_LOW_INDEX(_a, _b, _result) ((((_a) ^ (_b) ^ (_result)) & 0x10) | ((_result) & 0x0F))
+
 /* Add memory to Accumulator.
  * A + M + C -> A, C
  *
@@ -18,29 +50,32 @@
  * | N Z C I D V |
  * | + + + - - + |
  */
-void mos6507_ADC(uint8_t data)
+void mos6507_ADC(mos6507 *cpu, uint8_t data)
 {
-    uint16_t tmp = 0;
-    uint8_t accumulator = 0;
-    mos6507_get_register(MOS6507_REG_A, &accumulator);
+    uint8_t accumulator = cpu->A;
+    uint16_t tmp = accumulator + data + cpu->C;
 
-    if (mos6507_get_status_flag(MOS6507_STATUS_FLAG_DECIMAL)) {
+    if (cpu->P & MOS6507_STATUS_FLAG_DECIMAL) {
         /* Interesting! According to Bill Mensch of MOS Technologies this
          * feature did actually get used by Atari for their port of Asteroids.
          * https://www.youtube.com/watch?v=Ne1ApyqSvm0 (55:00)
+         *
+         * Z comes from the binary sum, N and V from the sum once only the
+         * low digit has been corrected and C from the final result.
          */
+        cpu->Z = tmp;
+        tmp += mos6507_adc_decimal_low[DECIMAL_LOW_INDEX(accumulator, data, tmp)];
+        cpu->N = tmp;
+        cpu->V = (~(accumulator ^ data) & (accumulator ^ tmp) & 0x80) ? 1 : 0;
+        tmp += mos6507_adc_decimal_high[tmp >> 4];
+        cpu->C = (tmp > 0xFF);
     } else {
-        tmp = data + accumulator + (mos6507_get_status_flag(MOS6507_STATUS_FLAG_CARRY) ? 1 : 0);
-        mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (tmp & 0x80));
-        mos6507_set_status_flag(MOS6507_STATUS_FLAG_CARRY, (tmp > 0xFF));
-        mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(tmp & 0xFF));
-        mos6507_set_status_flag(
-            MOS6507_STATUS_FLAG_OVERFLOW,
-            !((accumulator ^ data) & 0x80) && ((accumulator ^ tmp) & 0x80)
-        );
+        cpu->C = tmp >> 8;
+        cpu->V = (~(accumulator ^ data) & (accumulator ^ tmp) & 0x80) ? 1 : 0;
+        mos6507_set_NZ(cpu, tmp);
     }
 
-    mos6507_set_register(MOS6507_REG_A, (tmp & 0xFF));
+    cpu->A = tmp;
 }
 
 /* Logical AND memory with Accumulator.
@@ -51,16 +86,10 @@ void mos6507_ADC(uint8_t data)
  * | N Z C I D V |
  * | + + - - - - |
  */
-void mos6507_AND(uint8_t data)
+void mos6507_AND(mos6507 *cpu, uint8_t data)
 {
-    uint8_t accumulator, tmp = 0;
-    mos6507_get_register(MOS6507_REG_A, &accumulator);
-
-    tmp = accumulator & data;
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (tmp & 0x80));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(tmp & 0xFF));
-
-    mos6507_set_register(MOS6507_REG_A, tmp);
+    cpu->A &= data;
+    mos6507_set_NZ(cpu, cpu->A);
 }
 
 /* Shift left by one bit.
@@ -71,16 +100,11 @@ void mos6507_AND(uint8_t data)
  * | N Z C I D V |
  * | + + + - - - |
  */
-void mos6507_ASL(uint8_t *data)
+void mos6507_ASL(mos6507 *cpu, uint8_t *data)
 {
-    uint16_t tmp = *data;
-
-    tmp <<= 1;
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_CARRY, (tmp & 0x100));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (tmp & 0x80));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(tmp & 0xFF));
-
-    *data = (tmp & 0xFF);
+    cpu->C = *data >> 7;
+    *data <<= 1;
+    mos6507_set_NZ(cpu, *data);
 }
 
 /* Shift Accumulator left by one bit.
@@ -91,20 +115,9 @@ void mos6507_ASL(uint8_t *data)
  * | N Z C I D V |
  * | + + + - - - |
  */
-void mos6507_ASL_Accumulator(void)
+void mos6507_ASL_Accumulator(mos6507 *cpu)
 {
-    uint8_t accumulator;
-    uint16_t tmp;
-    mos6507_get_register(MOS6507_REG_A, &accumulator);
-    tmp = accumulator;
-
-    tmp <<= 1;
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_CARRY, (tmp & 0x100));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (tmp & 0x80));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(tmp & 0xFF));
-
-    accumulator = (tmp & 0xFF);
-    mos6507_set_register(MOS6507_REG_A, accumulator);
+    mos6507_ASL(cpu, &cpu->A);
 }
 
 /* Test bits in memory with Accumulator. Bits 7 and 6 of operand are transfered
@@ -117,16 +130,11 @@ void mos6507_ASL_Accumulator(void)
  * | N Z C I D V |
  * | 7 + - - - 6 |
  */
-void mos6507_BIT(uint8_t data)
+void mos6507_BIT(mos6507 *cpu, uint8_t data)
 {
-    uint8_t accumulator, tmp = 0;
-    mos6507_get_register(MOS6507_REG_A, &accumulator);
-
-    tmp = accumulator & data;
-
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (data & MOS6507_STATUS_FLAG_NEGATIVE));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_OVERFLOW, (data & MOS6507_STATUS_FLAG_OVERFLOW));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(tmp & 0xFF));
+    cpu->N = data;
+    cpu->V = (data & MOS6507_STATUS_FLAG_OVERFLOW) ? 1 : 0;
+    cpu->Z = cpu->A & data;
 }
 
 /* Compare memory with Accumulator.
@@ -137,17 +145,12 @@ void mos6507_BIT(uint8_t data)
  * | N Z C I D V |
  * | + + + - - - |
  */
-void mos6507_CMP(uint8_t data)
+void mos6507_CMP(mos6507 *cpu, uint8_t data)
 {
-    uint16_t tmp = 0;
-    uint8_t accumulator = 0;
-
-    mos6507_get_register(MOS6507_REG_A, &accumulator);
+    uint16_t tmp = cpu->A - data;
 
-    tmp = accumulator - data;
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_CARRY, (tmp < 0x0100));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (tmp & 0x80));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(tmp & 0xFF));
+    cpu->C = (tmp < 0x0100);
+    mos6507_set_NZ(cpu, tmp);
 }
 
 /* Compare memory with Index X.
@@ -158,17 +161,12 @@ void mos6507_CMP(uint8_t data)
  * | N Z C I D V |
  * | + + + - - - |
  */
-void mos6507_CPX(uint8_t data)
+void mos6507_CPX(mos6507 *cpu, uint8_t data)
 {
-    uint16_t tmp = 0;
-    uint8_t X = 0;
+    uint16_t tmp = cpu->X - data;
 
-    mos6507_get_register(MOS6507_REG_X, &X);
-
-    tmp = X - data;
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_CARRY, (tmp < 0x0100));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (tmp & 0x80));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(tmp & 0xFF));
+    cpu->C = (tmp < 0x0100);
+    mos6507_set_NZ(cpu, tmp);
 }
 
 /* Compare memory with Index Y.
@@ -179,17 +177,12 @@ void mos6507_CPX(uint8_t data)
  * | N Z C I D V |
  * | + + + - - - |
  */
-void mos6507_CPY(uint8_t data)
+void mos6507_CPY(mos6507 *cpu, uint8_t data)
 {
-    uint16_t tmp = 0;
-    uint8_t Y = 0;
-
-    mos6507_get_register(MOS6507_REG_Y, &Y);
+    uint16_t tmp = cpu->Y - data;
 
-    tmp = Y - data;
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_CARRY, (tmp < 0x0100));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (tmp & 0x80));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(tmp & 0xFF));
+    cpu->C = (tmp < 0x0100);
+    mos6507_set_NZ(cpu, tmp);
 }
 
 /* Exclusive OR memory with Accumulator.
@@ -200,16 +193,10 @@ void mos6507_CPY(uint8_t data)
  * | N Z C I D V |
  * | + + - - - - |
  */
-void mos6507_EOR(uint8_t data)
+void mos6507_EOR(mos6507 *cpu, uint8_t data)
 {
-    uint8_t accumulator, tmp = 0;
-    mos6507_get_register(MOS6507_REG_A, &accumulator);
-
-    tmp = accumulator ^ data;
-
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (tmp & 0x80));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(tmp & 0xFF));
-    mos6507_set_register(MOS6507_REG_A, tmp);
+    cpu->A ^= data;
+    mos6507_set_NZ(cpu, cpu->A);
 }
 
 /* Shift right by one bit.
@@ -220,11 +207,11 @@ void mos6507_EOR(uint8_t data)
  * | N Z C I D V |
  * | - + + - - - |
  */
-void mos6507_LSR(uint8_t *data)
+void mos6507_LSR(mos6507 *cpu, uint8_t *data)
 {
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_CARRY, (*data & 0x01));
+    cpu->C = *data & 0x01;
     *data >>= 1;
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(*data & 0xFF));
+    cpu->Z = *data;
 }
 
 /* Shift right by one bit in the Accumulator.
@@ -235,14 +222,9 @@ void mos6507_LSR(uint8_t *data)
  * | N Z C I D V |
  * | - + + - - - |
  */
-void mos6507_LSR_Accumulator(void)
+void mos6507_LSR_Accumulator(mos6507 *cpu)
 {
-    uint8_t accumulator;
-    mos6507_get_register(MOS6507_REG_A, &accumulator);
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_CARRY, (accumulator & 0x01));
-    accumulator >>= 1;
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(accumulator & 0xFF));
-    mos6507_set_register(MOS6507_REG_A, accumulator);
+    mos6507_LSR(cpu, &cpu->A);
 }
 
 /* Logical OR memory with Accumulator.
@@ -253,32 +235,13 @@ void mos6507_LSR_Accumulator(void)
  * | N Z C I D V |
  * | + + - - - - |
  */
-void mos6507_ORA(uint8_t *data)
+void mos6507_ORA(mos6507 *cpu, uint8_t *data)
 {
-    uint8_t accumulator, tmp = 0;
-    mos6507_get_register(MOS6507_REG_A, &accumulator);
-
-    tmp = accumulator | *data;
-
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (tmp & 0x80));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(tmp & 0xFF));
-    mos6507_set_register(MOS6507_REG_A, tmp);
+    cpu->A |= *data;
+    mos6507_set_NZ(cpu, cpu->A);
 }
 
 
-// WTF
-void mos6507_TSB(uint8_t *data)
-{
-    uint8_t accumulator, tmp = 0;
-    mos6507_get_register(MOS6507_REG_A, &accumulator);
-
-    tmp = accumulator | *data;
-
-//    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (tmp & 0x80));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, (*data & tmp));
-    mos6507_set_register(MOS6507_REG_A, tmp);
-}
-
 /* Rotate one bit left.
  * C <- [76543210] <- C
  *
@@ -287,18 +250,13 @@ void mos6507_TSB(uint8_t *data)
  * | N Z C I D V |
  * | + + + - - - |
  */
-void mos6507_ROL(uint8_t *data)
+void mos6507_ROL(mos6507 *cpu, uint8_t *data)
 {
-    uint16_t tmp = 0;
+    uint8_t carry = *data >> 7;
 
-    tmp = *data << 1;
-    if (mos6507_get_status_flag(MOS6507_STATUS_FLAG_CARRY)) {
-        tmp |= 0x01;
-    }
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (tmp & 0x80));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(tmp & 0xFF));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_CARRY, (tmp & 0x0100));
-    *data = (tmp & 0xFF);
+    *data = (*data << 1) | cpu->C;
+    cpu->C = carry;
+    mos6507_set_NZ(cpu, *data);
 }
 
 /* Rotate Accumulator one bit left.
@@ -309,21 +267,9 @@ void mos6507_ROL(uint8_t *data)
  * | N Z C I D V |
  * | + + + - - - |
  */
-void mos6507_ROL_Accumulator(void)
+void mos6507_ROL_Accumulator(mos6507 *cpu)
 {
-    uint16_t tmp = 0;
-    uint8_t accumulator;
-    mos6507_get_register(MOS6507_REG_A, &accumulator);
-
-    tmp = accumulator << 1;
-    if (mos6507_get_status_flag(MOS6507_STATUS_FLAG_CARRY)) {
-        tmp |= 0x01;
-    }
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (tmp & 0x80));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(tmp & 0xFF));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_CARRY, (tmp & 0x0100));
-    accumulator = (tmp & 0xFF);
-    mos6507_set_register(MOS6507_REG_A, accumulator);
+    mos6507_ROL(cpu, &cpu->A);
 }
 
 /* Rotate one bit right.
@@ -334,20 +280,13 @@ void mos6507_ROL_Accumulator(void)
  * | N Z C I D V |
  * | + + + - - - |
  */
-void mos6507_ROR(uint8_t *data)
+void mos6507_ROR(mos6507 *cpu, uint8_t *data)
 {
-    uint16_t tmp = 0;
-    uint8_t tmpCarry = 0;
+    uint8_t carry = *data & 0x01;
 
-    tmpCarry = (*data & 0x01);
-    tmp = *data >> 1;
-    if (mos6507_get_status_flag(MOS6507_STATUS_FLAG_CARRY)) {
-        tmp |= 0x80;
-    }
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (tmp & 0x80));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(tmp & 0xFF));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_CARRY, tmpCarry);
-    *data = (tmp & 0xFF);
+    *data = (*data >> 1) | (cpu->C << 7);
+    cpu->C = carry;
+    mos6507_set_NZ(cpu, *data);
 }
 
 /* Rotate Accumulator one bit right.
@@ -358,49 +297,233 @@ void mos6507_ROR(uint8_t *data)
  * | N Z C I D V |
  * | + + + - - - |
  */
-void mos6507_ROR_Accumulator(void)
+void mos6507_ROR_Accumulator(mos6507 *cpu)
 {
-    uint16_t tmp, tmpCarry = 0;
-    uint8_t accumulator;
-    mos6507_get_register(MOS6507_REG_A, &accumulator);
-
-    tmpCarry = accumulator & 0x01;
-    tmp = accumulator >> 1;
-    if (mos6507_get_status_flag(MOS6507_STATUS_FLAG_CARRY)) {
-        tmp |= 0x80;
-    }
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (tmp & 0x80));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(tmp & 0xFF));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_CARRY, tmpCarry);
-    accumulator = (tmp & 0xFF);
-    mos6507_set_register(MOS6507_REG_A, accumulator);
+    mos6507_ROR(cpu, &cpu->A);
 }
 /* Subtract memory from Accumulator with borrow.
- * A - M - C -> A
+ * A - M - ~C -> A
  *
  * Status flag changes (+ = conditionally modified, 1 = set, 0 = cleared):
  *
  * | N Z C I D V |
  * | + + + - - + |
  */
-void mos6507_SBC(uint8_t data)
+void mos6507_SBC(mos6507 *cpu, uint8_t data)
+{
+    uint8_t accumulator = cpu->A;
+    uint16_t tmp = accumulator - data - !cpu->C;
+
+    /* All the flags come from the binary result, even in decimal mode */
+    cpu->C = !(tmp & 0x8000);
+    cpu->V = ((accumulator ^ data) & (accumulator ^ tmp) & 0x80) ? 1 : 0;
+    mos6507_set_NZ(cpu, tmp);
+
+    if (cpu->P & MOS6507_STATUS_FLAG_DECIMAL) {
+        tmp += mos6507_sbc_decimal_low[DECIMAL_LOW_INDEX(accumulator, data, tmp)];
+        tmp -= mos6507_sbc_decimal_high[cpu->C];
+    }
+
+    cpu->A = tmp;
+}
+
+/******************************************************************************
+ * Undocumented op-codes
+ *
+ * Combinations the NMOS part decodes without being designed to. Behaviour
+ * follows "No More Secrets" (NMOS 6510 Unintended Opcodes). The unstable
+ * ones which depend on the analogue state of the chip use the values most
+ * often observed on real hardware.
+ *****************************************************************************/
+
+/* Load Accumulator and X with memory.
+ * M -> A -> X
+ *
+ * | N Z C I D V |
+ * | + + - - - - |
+ */
+void mos6507_LAX(mos6507 *cpu, uint8_t data)
+{
+    cpu->A = cpu->X = data;
+    mos6507_set_NZ(cpu, data);
+}
+
+/* Shift left, then OR with Accumulator.
+ * M << 1 -> M, A | M -> A
+ *
+ * | N Z C I D V |
+ * | + + + - - - |
+ */
+void mos6507_SLO(mos6507 *cpu, uint8_t *data)
+{
+    mos6507_ASL(cpu, data);
+    mos6507_ORA(cpu, data);
+}
+
+/* Rotate left, then AND with Accumulator.
+ * M << 1 | C -> M, A & M -> A
+ *
+ * | N Z C I D V |
+ * | + + + - - - |
+ */
+void mos6507_RLA(mos6507 *cpu, uint8_t *data)
+{
+    mos6507_ROL(cpu, data);
+    mos6507_AND(cpu, *data);
+}
+
+/* Shift right, then exclusive-OR with Accumulator.
+ * M >> 1 -> M, A ^ M -> A
+ *
+ * | N Z C I D V |
+ * | + + + - - - |
+ */
+void mos6507_SRE(mos6507 *cpu, uint8_t *data)
+{
+    mos6507_LSR(cpu, data);
+    mos6507_EOR(cpu, *data);
+}
+
+/* Rotate right, then add to Accumulator with the carry rotated out.
+ * C << 7 | M >> 1 -> M, A + M + C -> A
+ *
+ * | N Z C I D V |
+ * | + + + - - + |
+ */
+void mos6507_RRA(mos6507 *cpu, uint8_t *data)
 {
-    uint16_t tmp = 0;
-    uint8_t accumulator = 0;
-    mos6507_get_register(MOS6507_REG_A, &accumulator);
+    mos6507_ROR(cpu, data);
+    mos6507_ADC(cpu, *data);
+}
+
+/* Decrement memory, then compare with Accumulator.
+ * M - 1 -> M, A - M
+ *
+ * | N Z C I D V |
+ * | + + + - - - |
+ */
+void mos6507_DCP(mos6507 *cpu, uint8_t *data)
+{
+    (*data)--;
+    mos6507_CMP(cpu, *data);
+}
+
+/* Increment memory, then subtract from Accumulator with borrow.
+ * M + 1 -> M, A - M - ~C -> A
+ *
+ * | N Z C I D V |
+ * | + + + - - + |
+ */
+void mos6507_ISB(mos6507 *cpu, uint8_t *data)
+{
+    (*data)++;
+    mos6507_SBC(cpu, *data);
+}
+
+/* AND with Accumulator, copying the result's sign into carry.
+ * A & M -> A, A[7] -> C
+ *
+ * | N Z C I D V |
+ * | + + + - - - |
+ */
+void mos6507_ANC(mos6507 *cpu, uint8_t data)
+{
+    mos6507_AND(cpu, data);
+    cpu->C = cpu->A >> 7;
+}
+
+/* AND with Accumulator, then shift the Accumulator right.
+ * (A & M) >> 1 -> A
+ *
+ * | N Z C I D V |
+ * | 0 + + - - - |
+ */
+void mos6507_ALR(mos6507 *cpu, uint8_t data)
+{
+    uint8_t tmp = cpu->A & data;
+
+    cpu->C = tmp & 0x01;
+    cpu->A = tmp >> 1;
+    mos6507_set_NZ(cpu, cpu->A);
+}
 
-    if (mos6507_get_status_flag(MOS6507_STATUS_FLAG_DECIMAL)) {
-        // TODO
+/* AND with Accumulator, then rotate the Accumulator right. The adder is
+ * involved, so C and V come from bits 6 and 5 of the result and in decimal
+ * mode each digit is corrected as ADC would.
+ * C << 7 | (A & M) >> 1 -> A
+ *
+ * | N Z C I D V |
+ * | + + + - - + |
+ */
+void mos6507_ARR(mos6507 *cpu, uint8_t data)
+{
+    uint8_t tmp = cpu->A & data;
+
+    cpu->A = (tmp >> 1) | (cpu->C << 7);
+    mos6507_set_NZ(cpu, cpu->A);
+    if (cpu->P & MOS6507_STATUS_FLAG_DECIMAL) {
+        cpu->V = ((tmp ^ cpu->A) & 0x40) ? 1 : 0;
+        if ((tmp & 0x0F) + (tmp & 0x01) > 0x05) {
+            cpu->A = (cpu->A & 0xF0) | ((cpu->A + 0x06) & 0x0F);
+        }
+        cpu->C = ((tmp & 0xF0) + (tmp & 0x10) > 0x50);
+        if (cpu->C) {
+            cpu->A += 0x60;
+        }
     } else {
-        tmp = accumulator - data - (mos6507_get_status_flag(MOS6507_STATUS_FLAG_CARRY) ? 1 : 0);
-        mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (tmp & 0x80));
-        mos6507_set_status_flag(MOS6507_STATUS_FLAG_CARRY, !(tmp & 0x8000));
-        mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(tmp & 0xFF));
-        mos6507_set_status_flag(
-            MOS6507_STATUS_FLAG_OVERFLOW,
-            !((accumulator ^ data) & 0x80) && ((accumulator ^ tmp) & 0x80)
-        );
+        cpu->C = (cpu->A >> 6) & 0x01;
+        cpu->V = ((cpu->A >> 6) ^ (cpu->A >> 5)) & 0x01;
     }
+}
 
-    mos6507_set_register(MOS6507_REG_A, (tmp & 0xFF));
+/* AND Accumulator with X, then subtract memory without borrow into X.
+ * (A & X) - M -> X
+ *
+ * | N Z C I D V |
+ * | + + + - - - |
+ */
+void mos6507_SBX(mos6507 *cpu, uint8_t data)
+{
+    uint16_t tmp = (cpu->A & cpu->X) - data;
+
+    cpu->C = (tmp < 0x0100);
+    cpu->X = tmp;
+    mos6507_set_NZ(cpu, cpu->X);
+}
+
+/* Unstable: AND X and memory into Accumulator, through a bus conflict which
+ * leaves most of A's bits set.
+ * (A | 0xEE) & X & M -> A
+ *
+ * | N Z C I D V |
+ * | + + - - - - |
+ */
+void mos6507_ANE(mos6507 *cpu, uint8_t data)
+{
+    cpu->A = (cpu->A | 0xEE) & cpu->X & data;
+    mos6507_set_NZ(cpu, cpu->A);
+}
+
+/* Unstable: load Accumulator and X with memory, through the same bus
+ * conflict as ANE.
+ * (A | 0xEE) & M -> A -> X
+ *
+ * | N Z C I D V |
+ * | + + - - - - |
+ */
+void mos6507_LXA(mos6507 *cpu, uint8_t data)
+{
+    mos6507_LAX(cpu, (cpu->A | 0xEE) & data);
+}
+
+/* AND memory with the stack pointer into Accumulator, X and stack pointer.
+ * M & S -> A -> X -> S
+ *
+ * | N Z C I D V |
+ * | + + - - - - |
+ */
+void mos6507_LAS(mos6507 *cpu, uint8_t data)
+{
+    cpu->S &= data;
+    mos6507_LAX(cpu, cpu->S);
 }
@@ -11,28 +11,42 @@
 #define _MOS6507_MICROCODE_H
 
 #include <stdint.h>
-
-void mos6507_ADC(uint8_t data);
-void mos6507_AND(uint8_t data);
-void mos6507_ASL(uint8_t *data);
-void mos6507_ASL_Accumulator(void);
-void mos6507_BIT(uint8_t data);
-void mos6507_CMP(uint8_t data);
-void mos6507_CPX(uint8_t data);
-void mos6507_CPY(uint8_t data);
-void mos6507_EOR(uint8_t data);
-void mos6507_LSR(uint8_t *data);
-void mos6507_LSR_Accumulator(void);
-void mos6507_ORA(uint8_t *data);
-
-void mos6507_ROL(uint8_t *data);
-void mos6507_ROL_Accumulator(void);
-void mos6507_ROR(uint8_t *data);
-void mos6507_ROR_Accumulator(void);
-void mos6507_SBC(uint8_t data);
-
-void mos6507_TSB(uint8_t *data);
-
+#include "mos6507.h"
+
+void mos6507_ADC(mos6507 *cpu, uint8_t data);
+void mos6507_AND(mos6507 *cpu, uint8_t data);
+void mos6507_ASL(mos6507 *cpu, uint8_t *data);
+void mos6507_ASL_Accumulator(mos6507 *cpu);
+void mos6507_BIT(mos6507 *cpu, uint8_t data);
+void mos6507_CMP(mos6507 *cpu, uint8_t data);
+void mos6507_CPX(mos6507 *cpu, uint8_t data);
+void mos6507_CPY(mos6507 *cpu, uint8_t data);
+void mos6507_EOR(mos6507 *cpu, uint8_t data);
+void mos6507_LSR(mos6507 *cpu, uint8_t *data);
+void mos6507_LSR_Accumulator(mos6507 *cpu);
+void mos6507_ORA(mos6507 *cpu, uint8_t *data);
+
+void mos6507_ROL(mos6507 *cpu, uint8_t *data);
+void mos6507_ROL_Accumulator(mos6507 *cpu);
+void mos6507_ROR(mos6507 *cpu, uint8_t *data);
+void mos6507_ROR_Accumulator(mos6507 *cpu);
+void mos6507_SBC(mos6507 *cpu, uint8_t data);
+
+/* Undocumented */
+void mos6507_LAX(mos6507 *cpu, uint8_t data);
+void mos6507_SLO(mos6507 *cpu, uint8_t *data);
+void mos6507_RLA(mos6507 *cpu, uint8_t *data);
+void mos6507_SRE(mos6507 *cpu, uint8_t *data);
+void mos6507_RRA(mos6507 *cpu, uint8_t *data);
+void mos6507_DCP(mos6507 *cpu, uint8_t *data);
+void mos6507_ISB(mos6507 *cpu, uint8_t *data);
+void mos6507_ANC(mos6507 *cpu, uint8_t data);
+void mos6507_ALR(mos6507 *cpu, uint8_t data);
+void mos6507_ARR(mos6507 *cpu, uint8_t data);
+void mos6507_SBX(mos6507 *cpu, uint8_t data);
+void mos6507_ANE(mos6507 *cpu, uint8_t data);
+void mos6507_LXA(mos6507 *cpu, uint8_t data);
+void mos6507_LAS(mos6507 *cpu, uint8_t data);
 
 #endif /* _MOS6507_MICROCODE_H */
 
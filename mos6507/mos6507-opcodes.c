@@ -12,6 +12,7 @@
  * http://www.obelisk.me.uk/6502/reference.html
  */
 
+#include "../atari/Atari-2600.h"
 #include "../atari/Atari-memmap.h"
 #include "mos6507.h"
 #include "mos6507-opcodes.h"
@@ -23,480 +24,49 @@
  * address busses for the next op-code
  */
 #define END_OPCODE() \
-    mos6507_increment_PC(); \
-    mos6507_set_address_bus(mos6507_get_PC());
+    mos6507_increment_PC(cpu); \
+    mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
 
 #define STACK_PAGE 0x01
 
-instruction_t ISA_table[ISA_LENGTH];
+/* Each handler below is written once for every addressing mode it accepts.
+ * They're inlined into a specialised handler per op-code at the bottom of
+ * this file, where the mode is a constant and the addressing macros reduce
+ * to the single case which applies.
+ */
+#define OPCODE_INLINE static inline __attribute__((always_inline))
 
-/* Looks up an instruction from the instruction table and
- * executes the corresponding function, passing along cycle
- * time and addressing mode.
+/* The table is read on every cycle, so it can be kept in SRAM on the Pico
+ * rather than fetched through the flash cache.
+ */
+#if PICO_ON_DEVICE && MOS6507_ISA_TABLE_IN_RAM
+    #include "pico/platform.h"
+    #define ISA_TABLE_SECTION __not_in_flash("mos6507")
+#else
+    #define ISA_TABLE_SECTION
+#endif
+
+/* Looks up the CPU's current instruction from the instruction table
+ * and executes the corresponding function, passing along cycle time
+ * and addressing mode. Progress through the instruction is kept in
+ * the CPU model between calls.
  *
- * opcode: value of the instruction, e.g., 0x00 for BRK
+ * Returns the cycle the instruction has reached, 0 once it has completed
+ * or -1 if the CPU has jammed.
  */
-int opcode_execute(uint8_t opcode)
-{
-    static int cycle = 0;
-    if (-1 == ISA_table[opcode].opcode(cycle, ISA_table[opcode].addressing_mode)) {
-        cycle++;
-    } else {
-        cycle = 0;
-    }
-    return cycle;
-}
-
-int opcode_validate(uint8_t opcode)
+int opcode_execute(atari2600_t *atari)
 {
-    if (ISA_table[opcode].opcode == opcode_ILL) {
+    mos6507 *cpu = &atari->cpu;
+    const instruction_t *instruction = &ISA_table[cpu->current_instruction];
+    int result = instruction->opcode(atari, cpu->current_clock);
+    if (-1 == result) {
+        cpu->current_clock++;
+    } else if (OPCODE_HALTED == result) {
         return -1;
+    } else {
+        cpu->current_clock = 0;
     }
-    return 0;
-}
-
-/* Loads an array with function pointers to the corresponding
- * instruction. E.g., LDY is 0x0C so index 12 of the ISA table
- * would be loaded with a pointer to function opcode_LDY().
- */
-void opcode_populate_ISA_table(void)
-{
-    int i = 0;
-    /* Initially, fill the entire table with ILL */
-    for (i=0; i<ISA_LENGTH; i++) {
-        ISA_table[i].opcode = opcode_ILL;
-        ISA_table[i].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-    }
-
-    /* Now fill out the actual codes supported by a real 6507 */
-
-    /* 0x00: BRK, Implied */
-    ISA_table[0x00].opcode = opcode_BRK;
-    ISA_table[0x00].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Load accumulator with memory */
-    ISA_table[0xA9].opcode = opcode_LDA;
-    ISA_table[0xA9].addressing_mode = OPCODE_ADDRESSING_MODE_IMMEDIATE;
-    ISA_table[0xA5].opcode = opcode_LDA;
-    ISA_table[0xA5].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0xB5].opcode = opcode_LDA;
-    ISA_table[0xB5].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_X_INDEXED;
-    ISA_table[0xAD].opcode = opcode_LDA;
-    ISA_table[0xAD].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-    ISA_table[0xBD].opcode = opcode_LDA;
-    ISA_table[0xBD].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_X_INDEXED;
-    ISA_table[0xB9].opcode = opcode_LDA;
-    ISA_table[0xB9].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_Y_INDEXED;
-    ISA_table[0xA1].opcode = opcode_LDA;
-    ISA_table[0xA1].addressing_mode = OPCODE_ADDRESSING_MODE_INDIRECT_X_INDEXED;
-    ISA_table[0xB1].opcode = opcode_LDA;
-    ISA_table[0xB1].addressing_mode = OPCODE_ADDRESSING_MODE_INDIRECT_Y_INDEXED;
-
-    /* Load Index X with memory */
-    ISA_table[0xA2].opcode = opcode_LDX;
-    ISA_table[0xA2].addressing_mode = OPCODE_ADDRESSING_MODE_IMMEDIATE;
-    ISA_table[0xA6].opcode = opcode_LDX;
-    ISA_table[0xA6].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0xB6].opcode = opcode_LDX;
-    ISA_table[0xB6].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_Y_INDEXED;
-    ISA_table[0xAE].opcode = opcode_LDX;
-    ISA_table[0xAE].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-    ISA_table[0xBE].opcode = opcode_LDX;
-    ISA_table[0xBE].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_Y_INDEXED;
-
-    /* Load Index Y with memory */
-    ISA_table[0xA0].opcode = opcode_LDY;
-    ISA_table[0xA0].addressing_mode = OPCODE_ADDRESSING_MODE_IMMEDIATE;
-    ISA_table[0xA4].opcode = opcode_LDY;
-    ISA_table[0xA4].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0xB4].opcode = opcode_LDY;
-    ISA_table[0xB4].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_X_INDEXED;
-    ISA_table[0xAC].opcode = opcode_LDY;
-    ISA_table[0xAC].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-    ISA_table[0xBC].opcode = opcode_LDY;
-    ISA_table[0xBC].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_X_INDEXED;
-
-    /* Store Accumulator in memory */
-    ISA_table[0x85].opcode = opcode_STA;
-    ISA_table[0x85].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0x95].opcode = opcode_STA;
-    ISA_table[0x95].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_X_INDEXED;
-    ISA_table[0x8D].opcode = opcode_STA;
-    ISA_table[0x8D].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-    ISA_table[0x9D].opcode = opcode_STA;
-    ISA_table[0x9D].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_X_INDEXED;
-    ISA_table[0x99].opcode = opcode_STA;
-    ISA_table[0x99].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_Y_INDEXED;
-    ISA_table[0x81].opcode = opcode_STA;
-    ISA_table[0x81].addressing_mode = OPCODE_ADDRESSING_MODE_INDIRECT_X_INDEXED;
-    ISA_table[0x91].opcode = opcode_STA;
-    ISA_table[0x91].addressing_mode = OPCODE_ADDRESSING_MODE_INDIRECT_Y_INDEXED;
-
-    /* Store Index X in memory */
-    ISA_table[0x86].opcode = opcode_STX;
-    ISA_table[0x86].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0x96].opcode = opcode_STX;
-    ISA_table[0x96].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_Y_INDEXED;
-    ISA_table[0x8E].opcode = opcode_STX;
-    ISA_table[0x8E].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-
-    /* Store Index Y in memory */
-    ISA_table[0x84].opcode = opcode_STY;
-    ISA_table[0x84].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0x94].opcode = opcode_STY;
-    ISA_table[0x94].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_X_INDEXED;
-    ISA_table[0x8C].opcode = opcode_STY;
-    ISA_table[0x8C].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-
-    /* Add memory to Accumulator with carry */
-    ISA_table[0x69].opcode = opcode_ADC;
-    ISA_table[0x69].addressing_mode = OPCODE_ADDRESSING_MODE_IMMEDIATE;
-    ISA_table[0x65].opcode = opcode_ADC;
-    ISA_table[0x65].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0x75].opcode = opcode_ADC;
-    ISA_table[0x75].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_X_INDEXED;
-    ISA_table[0x6D].opcode = opcode_ADC;
-    ISA_table[0x6D].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-    ISA_table[0x7D].opcode = opcode_ADC;
-    ISA_table[0x7D].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_X_INDEXED;
-    ISA_table[0x79].opcode = opcode_ADC;
-    ISA_table[0x79].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_Y_INDEXED;
-    ISA_table[0x61].opcode = opcode_ADC;
-    ISA_table[0x61].addressing_mode = OPCODE_ADDRESSING_MODE_INDIRECT_X_INDEXED;
-    ISA_table[0x71].opcode = opcode_ADC;
-    ISA_table[0x71].addressing_mode = OPCODE_ADDRESSING_MODE_INDIRECT_Y_INDEXED;
-
-    /* Subtract memory from Accumulator with borrow */
-    ISA_table[0xE9].opcode = opcode_SBC;
-    ISA_table[0xE9].addressing_mode = OPCODE_ADDRESSING_MODE_IMMEDIATE;
-    ISA_table[0xE5].opcode = opcode_SBC;
-    ISA_table[0xE5].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0xF5].opcode = opcode_SBC;
-    ISA_table[0xF5].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_X_INDEXED;
-    ISA_table[0xED].opcode = opcode_SBC;
-    ISA_table[0xED].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-    ISA_table[0xFD].opcode = opcode_SBC;
-    ISA_table[0xFD].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_X_INDEXED;
-    ISA_table[0xF9].opcode = opcode_SBC;
-    ISA_table[0xF9].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_Y_INDEXED;
-    ISA_table[0xE1].opcode = opcode_SBC;
-    ISA_table[0xE1].addressing_mode = OPCODE_ADDRESSING_MODE_INDIRECT_X_INDEXED;
-    ISA_table[0xF1].opcode = opcode_SBC;
-    ISA_table[0xF1].addressing_mode = OPCODE_ADDRESSING_MODE_INDIRECT_Y_INDEXED;
-
-    /* Increment memory by one */
-    ISA_table[0xE6].opcode = opcode_INC;
-    ISA_table[0xE6].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0xF6].opcode = opcode_INC;
-    ISA_table[0xF6].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_X_INDEXED;
-    ISA_table[0xEE].opcode = opcode_INC;
-    ISA_table[0xEE].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-    ISA_table[0xFE].opcode = opcode_INC;
-    ISA_table[0xFE].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_X_INDEXED;
-
-    /* Increment Index X by one */
-    ISA_table[0xE8].opcode = opcode_INX;
-    ISA_table[0xE8].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Increment Index Y by one */
-    ISA_table[0xC8].opcode = opcode_INY;
-    ISA_table[0xC8].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Decrement memory by one */
-    ISA_table[0xC6].opcode = opcode_DEC;
-    ISA_table[0xC6].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0xD6].opcode = opcode_DEC;
-    ISA_table[0xD6].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_X_INDEXED;
-    ISA_table[0xCE].opcode = opcode_DEC;
-    ISA_table[0xCE].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-    ISA_table[0xDE].opcode = opcode_DEC;
-    ISA_table[0xDE].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_X_INDEXED;
-
-    /* Decrement Index X by one */
-    ISA_table[0xCA].opcode = opcode_DEX;
-    ISA_table[0xCA].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Decrement Index Y by one */
-    ISA_table[0x88].opcode = opcode_DEY;
-    ISA_table[0x88].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Logical AND with Accumulator */
-    ISA_table[0x21].opcode = opcode_AND;
-    ISA_table[0x21].addressing_mode = OPCODE_ADDRESSING_MODE_INDIRECT_X_INDEXED;
-    ISA_table[0x25].opcode = opcode_AND;
-    ISA_table[0x25].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0x29].opcode = opcode_AND;
-    ISA_table[0x29].addressing_mode = OPCODE_ADDRESSING_MODE_IMMEDIATE;
-    ISA_table[0x2D].opcode = opcode_AND;
-    ISA_table[0x2D].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-    ISA_table[0x31].opcode = opcode_AND;
-    ISA_table[0x31].addressing_mode = OPCODE_ADDRESSING_MODE_INDIRECT_Y_INDEXED;
-    ISA_table[0x35].opcode = opcode_AND;
-    ISA_table[0x35].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_X_INDEXED;
-    ISA_table[0x39].opcode = opcode_AND;
-    ISA_table[0x39].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_Y_INDEXED;
-    ISA_table[0x3D].opcode = opcode_AND;
-    ISA_table[0x3D].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_X_INDEXED;
-
-    /* Logical OR with Accumulator */
-    ISA_table[0x01].opcode = opcode_ORA;
-    ISA_table[0x01].addressing_mode = OPCODE_ADDRESSING_MODE_INDIRECT_X_INDEXED;
-    ISA_table[0x05].opcode = opcode_ORA;
-    ISA_table[0x05].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0x09].opcode = opcode_ORA;
-    ISA_table[0x09].addressing_mode = OPCODE_ADDRESSING_MODE_IMMEDIATE;
-    ISA_table[0x0D].opcode = opcode_ORA;
-    ISA_table[0x0D].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-    ISA_table[0x11].opcode = opcode_ORA;
-    ISA_table[0x11].addressing_mode = OPCODE_ADDRESSING_MODE_INDIRECT_Y_INDEXED;
-    ISA_table[0x15].opcode = opcode_ORA;
-    ISA_table[0x15].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_X_INDEXED;
-    ISA_table[0x19].opcode = opcode_ORA;
-    ISA_table[0x19].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_Y_INDEXED;
-    ISA_table[0x1D].opcode = opcode_ORA;
-    ISA_table[0x1D].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_X_INDEXED;
-
-    /* logical exclusive OR with Accumulator */
-    ISA_table[0x41].opcode = opcode_EOR;
-    ISA_table[0x41].addressing_mode = OPCODE_ADDRESSING_MODE_INDIRECT_X_INDEXED;
-    ISA_table[0x45].opcode = opcode_EOR;
-    ISA_table[0x45].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0x49].opcode = opcode_EOR;
-    ISA_table[0x49].addressing_mode = OPCODE_ADDRESSING_MODE_IMMEDIATE;
-    ISA_table[0x4D].opcode = opcode_EOR;
-    ISA_table[0x4D].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-    ISA_table[0x51].opcode = opcode_EOR;
-    ISA_table[0x51].addressing_mode = OPCODE_ADDRESSING_MODE_INDIRECT_Y_INDEXED;
-    ISA_table[0x55].opcode = opcode_EOR;
-    ISA_table[0x55].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_X_INDEXED;
-    ISA_table[0x59].opcode = opcode_EOR;
-    ISA_table[0x59].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_Y_INDEXED;
-    ISA_table[0x5D].opcode = opcode_EOR;
-    ISA_table[0x5D].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_X_INDEXED;
-
-    /* Jump to new location */
-    ISA_table[0x4C].opcode = opcode_JMP;
-    ISA_table[0x4c].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-    ISA_table[0x6C].opcode = opcode_JMP;
-    ISA_table[0x6C].addressing_mode = OPCODE_ADDRESSING_MODE_INDIRECT;
-
-    /* Branch on carry clear */
-    ISA_table[0x90].opcode = opcode_BCC;
-    ISA_table[0x90].addressing_mode = OPCODE_ADDRESSING_MODE_RELATIVE;
-
-    /* Branch on carry set */
-    ISA_table[0xB0].opcode = opcode_BCS;
-    ISA_table[0xB0].addressing_mode = OPCODE_ADDRESSING_MODE_RELATIVE;
-
-    /* Branch on result zero */
-    ISA_table[0xF0].opcode = opcode_BEQ;
-    ISA_table[0xF0].addressing_mode = OPCODE_ADDRESSING_MODE_RELATIVE;
-
-    /* Branch on result not zero */
-    ISA_table[0xD0].opcode = opcode_BNE;
-    ISA_table[0xD0].addressing_mode = OPCODE_ADDRESSING_MODE_RELATIVE;
-
-    /* Branch on result not zero */
-    ISA_table[0x30].opcode = opcode_BMI;
-    ISA_table[0x30].addressing_mode = OPCODE_ADDRESSING_MODE_RELATIVE;
-
-    /* Branch on result plus */
-    ISA_table[0x10].opcode = opcode_BPL;
-    ISA_table[0x10].addressing_mode = OPCODE_ADDRESSING_MODE_RELATIVE;
-
-    /* Branch on overflow set */
-    ISA_table[0x70].opcode = opcode_BVS;
-    ISA_table[0x70].addressing_mode = OPCODE_ADDRESSING_MODE_RELATIVE;
-
-    /* Branch on overflow clear */
-    ISA_table[0x50].opcode = opcode_BVC;
-    ISA_table[0x50].addressing_mode = OPCODE_ADDRESSING_MODE_RELATIVE;
-
-    /* Compare with Accumulator*/
-    ISA_table[0xC9].opcode = opcode_CMP;
-    ISA_table[0xC9].addressing_mode = OPCODE_ADDRESSING_MODE_IMMEDIATE;
-    ISA_table[0xC5].opcode = opcode_CMP;
-    ISA_table[0xC5].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0xD5].opcode = opcode_CMP;
-    ISA_table[0xD5].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_X_INDEXED;
-    ISA_table[0xCD].opcode = opcode_CMP;
-    ISA_table[0xCD].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-    ISA_table[0xDD].opcode = opcode_CMP;
-    ISA_table[0xDD].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_X_INDEXED;
-    ISA_table[0xD9].opcode = opcode_CMP;
-    ISA_table[0xD9].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_Y_INDEXED;
-    ISA_table[0xC1].opcode = opcode_CMP;
-    ISA_table[0xC1].addressing_mode = OPCODE_ADDRESSING_MODE_INDIRECT_X_INDEXED;
-    ISA_table[0xD1].opcode = opcode_CMP;
-    ISA_table[0xD1].addressing_mode = OPCODE_ADDRESSING_MODE_INDIRECT_Y_INDEXED;
-
-    /* Compare memory with Index X */
-    ISA_table[0xE0].opcode = opcode_CPX;
-    ISA_table[0xE0].addressing_mode = OPCODE_ADDRESSING_MODE_IMMEDIATE;
-    ISA_table[0xE4].opcode = opcode_CPX;
-    ISA_table[0xE4].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0xEC].opcode = opcode_CPX;
-    ISA_table[0xEC].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-
-    /* Compare memory with Index Y */
-    ISA_table[0xC0].opcode = opcode_CPY;
-    ISA_table[0xC0].addressing_mode = OPCODE_ADDRESSING_MODE_IMMEDIATE;
-    ISA_table[0xC4].opcode = opcode_CPY;
-    ISA_table[0xC4].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0xCC].opcode = opcode_CPY;
-    ISA_table[0xCC].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-
-    /* Test bits in memory with Accumulator */
-    ISA_table[0x24].opcode = opcode_BIT;
-    ISA_table[0x24].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0x2C].opcode = opcode_BIT;
-    ISA_table[0x2C].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-
-    /* Shift left one bit */
-    ISA_table[0x0A].opcode = opcode_ASL;
-    ISA_table[0x0A].addressing_mode = OPCODE_ADDRESSING_MODE_ACCUMULATOR;
-    ISA_table[0x06].opcode = opcode_ASL;
-    ISA_table[0x06].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0x16].opcode = opcode_ASL;
-    ISA_table[0x16].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_X_INDEXED;
-    ISA_table[0x0E].opcode = opcode_ASL;
-    ISA_table[0x0E].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-    ISA_table[0x1E].opcode = opcode_ASL;
-    ISA_table[0x1E].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_X_INDEXED;
-
-    /* Right shift one bit */
-    ISA_table[0x4A].opcode = opcode_LSR;
-    ISA_table[0x4A].addressing_mode = OPCODE_ADDRESSING_MODE_ACCUMULATOR;
-    ISA_table[0x46].opcode = opcode_LSR;
-    ISA_table[0x46].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0x56].opcode = opcode_LSR;
-    ISA_table[0x56].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_X_INDEXED;
-    ISA_table[0x4E].opcode = opcode_LSR;
-    ISA_table[0x4E].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-    ISA_table[0x5E].opcode = opcode_LSR;
-    ISA_table[0x5E].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_X_INDEXED;
-
-    /* Rotate one bit left */
-    ISA_table[0x2A].opcode = opcode_ROL;
-    ISA_table[0x2A].addressing_mode = OPCODE_ADDRESSING_MODE_ACCUMULATOR;
-    ISA_table[0x26].opcode = opcode_ROL;
-    ISA_table[0x26].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0x36].opcode = opcode_ROL;
-    ISA_table[0x36].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_X_INDEXED;
-    ISA_table[0x2E].opcode = opcode_ROL;
-    ISA_table[0x2E].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-    ISA_table[0x3E].opcode = opcode_ROL;
-    ISA_table[0x3E].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_X_INDEXED;
-
-    /* Rotate one bit right */
-    ISA_table[0x6A].opcode = opcode_ROR;
-    ISA_table[0x6A].addressing_mode = OPCODE_ADDRESSING_MODE_ACCUMULATOR;
-    ISA_table[0x66].opcode = opcode_ROR;
-    ISA_table[0x66].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
-    ISA_table[0x76].opcode = opcode_ROR;
-    ISA_table[0x76].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE_X_INDEXED;
-    ISA_table[0x6E].opcode = opcode_ROR;
-    ISA_table[0x6E].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-    ISA_table[0x7E].opcode = opcode_ROR;
-    ISA_table[0x7E].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE_X_INDEXED;
-
-    /* Transfer Accumulator to Index X */
-    ISA_table[0xAA].opcode = opcode_TAX;
-    ISA_table[0xAA].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Transfer Accumulator to Index Y */
-    ISA_table[0xA8].opcode = opcode_TAY;
-    ISA_table[0xA8].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Transfer Index X to Accumulator */
-    ISA_table[0x8A].opcode = opcode_TXA;
-    ISA_table[0x8A].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Transfer Index Y to Accumulator */
-    ISA_table[0x98].opcode = opcode_TYA;
-    ISA_table[0x98].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Transfer stack pointer to Index X */
-    ISA_table[0xBA].opcode = opcode_TSX;
-    ISA_table[0xBA].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Transfer Index X to stack register */
-    ISA_table[0x9A].opcode = opcode_TXS;
-    ISA_table[0x9A].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Push Accumulator onto stack */
-    ISA_table[0x48].opcode = opcode_PHA;
-    ISA_table[0x48].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Push processor status onto stack */
-    ISA_table[0x08].opcode = opcode_PHP;
-    ISA_table[0x08].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Pull Accumulator from stack */
-    ISA_table[0x68].opcode = opcode_PLA;
-    ISA_table[0x68].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Pull processor status from stack */
-    ISA_table[0x28].opcode = opcode_PLP;
-    ISA_table[0x28].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Jump to new location saving return address */
-    ISA_table[0x20].opcode = opcode_JSR;
-    ISA_table[0x20].addressing_mode = OPCODE_ADDRESSING_MODE_ABSOLUTE;
-
-    /* Return from subroutine */
-    ISA_table[0x60].opcode = opcode_RTS;
-    ISA_table[0x60].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Return from interrupt */
-    ISA_table[0x40].opcode = opcode_RTI;
-    ISA_table[0x40].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Clear carry flag */
-    ISA_table[0x18].opcode = opcode_CLC;
-    ISA_table[0x18].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Clear decimal mode */
-    ISA_table[0xD8].opcode = opcode_CLD;
-    ISA_table[0xD8].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Clear interrupt disable bit */
-    ISA_table[0x58].opcode = opcode_CLI;
-    ISA_table[0x58].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Clear overflow bit */
-    ISA_table[0xB8].opcode = opcode_CLV;
-    ISA_table[0xB8].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Set carry flag */
-    ISA_table[0x38].opcode = opcode_SEC;
-    ISA_table[0x38].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Set decimal flag */
-    ISA_table[0xF8].opcode = opcode_SED;
-    ISA_table[0xF8].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* Set interrupt disable status */
-    ISA_table[0x78].opcode = opcode_SEI;
-    ISA_table[0x78].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    /* No operation */
-    ISA_table[0xEA].opcode = opcode_NOP;
-    ISA_table[0xEA].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    ISA_table[0x02].opcode = opcode_NOP;
-    ISA_table[0x02].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    ISA_table[0x77].opcode = opcode_NOP;
-    ISA_table[0x77].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-    ISA_table[0x9C].opcode = opcode_NOP;
-    ISA_table[0x9C].addressing_mode = OPCODE_ADDRESSING_MODE_IMPLIED;
-
-
-    /* WTF */
-    ISA_table[0x04].opcode = opcode_TSB;
-    ISA_table[0x04].addressing_mode = OPCODE_ADDRESSING_MODE_ZERO_PAGE;
+    return cpu->current_clock;
 }
 
 /******************************************************************************
@@ -509,37 +79,31 @@ void opcode_populate_ISA_table(void)
  * actually present in the CPU itself.
  *****************************************************************************/
 
-int opcode_ILL(int cycle, addressing_mode_t address_mode)
-{
-    /* Halt and catch fire!! */
-    return 0;
-}
-
-int opcode_ADC(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_ADC(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bal, bah, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     FETCH_DATA()
-    mos6507_ADC(data);
+    mos6507_ADC(cpu, cpu->data);
     END_OPCODE()
     return 0;
 }
 
-int opcode_AND(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_AND(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bal, bah, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     FETCH_DATA()
-    mos6507_AND(data);
+    mos6507_AND(cpu, cpu->data);
     END_OPCODE()
     return 0;
 }
 
-int opcode_ASL(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_ASL(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bah, bal, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     if (OPCODE_ADDRESSING_MODE_ACCUMULATOR == address_mode) {
@@ -548,7 +112,7 @@ int opcode_ASL(int cycle, addressing_mode_t address_mode)
                 /* Consume clock cycle for fetching op-code */
                 return -1;
             case 1:
-                mos6507_ASL_Accumulator();
+                mos6507_ASL_Accumulator(cpu);
                 /* Intentional fall-through */
             default:
                 /* End of op-code execution */
@@ -559,169 +123,174 @@ int opcode_ASL(int cycle, addressing_mode_t address_mode)
     }
 
     FETCH_DATA()
-    mos6507_ASL(&data);
+    mos6507_ASL(cpu, &cpu->data);
     END_OPCODE()
     return 0;
 }
 
-int opcode_BCC(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_BCC(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t condition, offset = 0;
-    static uint16_t addr = 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t condition = 0;
     uint8_t compliment = 0;
 
-    condition = !mos6507_get_status_flag(MOS6507_STATUS_FLAG_CARRY);
+    condition = !mos6507_get_status_flag(cpu, MOS6507_STATUS_FLAG_CARRY);
 
     CALC_BRANCH()
 
-    mos6507_set_address_bus(mos6507_get_PC());
+    mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
     return 0;
 }
 
-int opcode_BCS(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_BCS(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t condition, offset = 0;
-    static uint16_t addr = 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t condition = 0;
     uint8_t compliment = 0;
 
-    condition = mos6507_get_status_flag(MOS6507_STATUS_FLAG_CARRY);
+    condition = mos6507_get_status_flag(cpu, MOS6507_STATUS_FLAG_CARRY);
 
     CALC_BRANCH()
 
-    mos6507_set_address_bus(mos6507_get_PC());
+    mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
     return 0;
 }
 
-int opcode_BEQ(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_BEQ(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t condition, offset = 0;
-    static uint16_t addr = 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t condition = 0;
     uint8_t compliment = 0;
 
-    condition = mos6507_get_status_flag(MOS6507_STATUS_FLAG_ZERO);
+    condition = mos6507_get_status_flag(cpu, MOS6507_STATUS_FLAG_ZERO);
 
     CALC_BRANCH()
 
-    mos6507_set_address_bus(mos6507_get_PC());
+    mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
     return 0;
 }
 
-int opcode_BIT(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_BIT(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bah, bal, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     FETCH_DATA()
-    mos6507_BIT(data);
+    mos6507_BIT(cpu, cpu->data);
     END_OPCODE()
     return 0;
 }
 
-int opcode_BMI(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_BMI(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t condition, offset = 0;
-    static uint16_t addr = 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t condition = 0;
     uint8_t compliment = 0;
 
-    condition = mos6507_get_status_flag(MOS6507_STATUS_FLAG_NEGATIVE);
+    condition = mos6507_get_status_flag(cpu, MOS6507_STATUS_FLAG_NEGATIVE);
 
     CALC_BRANCH()
 
-    mos6507_set_address_bus(mos6507_get_PC());
+    mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
     return 0;
 }
 
-int opcode_BNE(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_BNE(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t condition, offset = 0;
-    static uint16_t addr = 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t condition = 0;
     uint8_t compliment = 0;
 
-    condition = !mos6507_get_status_flag(MOS6507_STATUS_FLAG_ZERO);
+    condition = !mos6507_get_status_flag(cpu, MOS6507_STATUS_FLAG_ZERO);
 
     CALC_BRANCH()
 
-    mos6507_set_address_bus(mos6507_get_PC());
+    mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
     return 0;
 }
 
-int opcode_BPL(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_BPL(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t condition, offset = 0;
-    static uint16_t addr = 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t condition = 0;
     uint8_t compliment = 0;
 
-    condition = !mos6507_get_status_flag(MOS6507_STATUS_FLAG_NEGATIVE);
+    condition = !mos6507_get_status_flag(cpu, MOS6507_STATUS_FLAG_NEGATIVE);
 
     CALC_BRANCH()
 
-    mos6507_set_address_bus(mos6507_get_PC());
+    mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
     return 0;
 }
 
-int opcode_BRK(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_BRK(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, pcl, pch, S, P = 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t P = 0;
 
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_increment_PC();
+            /* BRK skips the padding byte which follows it */
+            mos6507_increment_PC(cpu);
+            mos6507_increment_PC(cpu);
             return -1;
         case 2:
-            pch = (uint8_t)(mos6507_get_PC() >> 8);
-            mos6507_push_stack(pch);
+            cpu->pch = (uint8_t)(mos6507_get_PC(cpu) >> 8);
+            mos6507_push_stack(atari, cpu->pch);
             return -1;
         case 3:
-            pcl = (uint8_t)mos6507_get_PC();
-            mos6507_push_stack(pcl);
+            cpu->pcl = (uint8_t)mos6507_get_PC(cpu);
+            mos6507_push_stack(atari, cpu->pcl);
             return -1;
         case 4:
-            mos6507_get_register(MOS6507_REG_P, &P);
-            mos6507_push_stack(P);
+            /* The break flag and unused bit 5 always read as set when pushed */
+            mos6507_get_register(cpu, MOS6507_REG_P, &P);
+            mos6507_push_stack(atari, P | MOS6507_STATUS_FLAG_BREAK | 0x20);
+            mos6507_set_status_flag(cpu, MOS6507_STATUS_FLAG_INTERRUPT, 1);
             return -1;
         case 5:
-            mos6507_set_address_bus(0xFFFE);
-            memmap_read(&adl);
+            mos6507_set_address_bus(cpu, 0xFFFE);
+            memmap_read(atari, &cpu->adl);
             return -1;
         case 6:
-            mos6507_set_address_bus(0xFFFF);
-            memmap_read(&adh);
+            mos6507_set_address_bus(cpu, 0xFFFF);
+            memmap_read(atari, &cpu->adh);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
             break;
     }
 
-    mos6507_set_PC_hl(adh, adl);
-    mos6507_set_address_bus(mos6507_get_PC());
+    mos6507_set_PC_hl(cpu, cpu->adh, cpu->adl);
+    mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
 
     return 0;
 }
 
-int opcode_BVC(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_BVC(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t condition, offset = 0;
-    static uint16_t addr = 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t condition = 0;
     uint8_t compliment = 0;
 
-    condition = !mos6507_get_status_flag(MOS6507_STATUS_FLAG_OVERFLOW);
+    condition = !mos6507_get_status_flag(cpu, MOS6507_STATUS_FLAG_OVERFLOW);
 
     CALC_BRANCH()
 
-    mos6507_set_address_bus(mos6507_get_PC());
+    mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
     return 0;
 }
 
-int opcode_BVS(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_BVS(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t condition, offset = 0;
-    static uint16_t addr = 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t condition = 0;
     uint8_t compliment = 0;
 
-    condition = mos6507_get_status_flag(MOS6507_STATUS_FLAG_OVERFLOW);
+    condition = mos6507_get_status_flag(cpu, MOS6507_STATUS_FLAG_OVERFLOW);
 
     CALC_BRANCH()
 
@@ -729,14 +298,16 @@ int opcode_BVS(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_CLC(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_CLC(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
+    mos6507 *cpu = &atari->cpu;
+
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_CARRY, 0);
+            mos6507_set_status_flag(cpu, MOS6507_STATUS_FLAG_CARRY, 0);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -747,14 +318,16 @@ int opcode_CLC(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_CLD(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_CLD(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
+    mos6507 *cpu = &atari->cpu;
+
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_DECIMAL, 0);
+            mos6507_set_status_flag(cpu, MOS6507_STATUS_FLAG_DECIMAL, 0);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -765,14 +338,16 @@ int opcode_CLD(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_CLI(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_CLI(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
+    mos6507 *cpu = &atari->cpu;
+
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_INTERRUPT, 0);
+            mos6507_set_status_flag(cpu, MOS6507_STATUS_FLAG_INTERRUPT, 0);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -783,14 +358,16 @@ int opcode_CLI(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_CLV(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_CLV(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
+    mos6507 *cpu = &atari->cpu;
+
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_OVERFLOW, 0);
+            mos6507_set_status_flag(cpu, MOS6507_STATUS_FLAG_OVERFLOW, 0);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -801,67 +378,66 @@ int opcode_CLV(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_CMP(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_CMP(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bal, bah, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     FETCH_DATA()
-    mos6507_CMP(data);
+    mos6507_CMP(cpu, cpu->data);
     END_OPCODE()
     return 0;
 }
 
-int opcode_CPX(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_CPX(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bah, bal, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     FETCH_DATA()
-    mos6507_CPX(data);
+    mos6507_CPX(cpu, cpu->data);
     END_OPCODE()
     return 0;
 }
 
-int opcode_CPY(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_CPY(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bah, bal, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     FETCH_DATA()
-    mos6507_CPY(data);
+    mos6507_CPY(cpu, cpu->data);
     END_OPCODE()
     return 0;
 }
 
-int opcode_DEC(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_DEC(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bah, bal, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     FETCH_DATA();
-    data--;
-    mos6507_set_data_bus(data);
-    memmap_write();
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(data & 0xFF));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (data & 0x80));
+    cpu->data--;
+    mos6507_set_data_bus(cpu, cpu->data);
+    memmap_write(atari);
+    mos6507_set_NZ(cpu, cpu->data);
     END_OPCODE()
     return 0;
 }
 
-int opcode_DEX(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_DEX(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t value = 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t value = 0;
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_get_register(MOS6507_REG_X, &value);
+            mos6507_get_register(cpu, MOS6507_REG_X, &value);
             value--;
-            mos6507_set_register(MOS6507_REG_X, value);
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(value & 0xFF));
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (value & 0x80));
+            mos6507_set_register(cpu, MOS6507_REG_X, value);
+            mos6507_set_NZ(cpu, value);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -872,19 +448,19 @@ int opcode_DEX(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_DEY(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_DEY(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t value = 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t value = 0;
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_get_register(MOS6507_REG_Y, &value);
+            mos6507_get_register(cpu, MOS6507_REG_Y, &value);
             value--;
-            mos6507_set_register(MOS6507_REG_Y, value);
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(value & 0xFF));
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (value & 0x80));
+            mos6507_set_register(cpu, MOS6507_REG_Y, value);
+            mos6507_set_NZ(cpu, value);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -895,45 +471,44 @@ int opcode_DEY(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_EOR(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_EOR(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bah, bal, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     FETCH_DATA()
-    mos6507_EOR(data);
+    mos6507_EOR(cpu, cpu->data);
     END_OPCODE()
     return 0;
 }
 
-int opcode_INC(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_INC(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bah, bal, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     FETCH_DATA();
-    data++;
-    mos6507_set_data_bus(data);
-    memmap_write();
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(data & 0xFF));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (data & 0x80));
+    cpu->data++;
+    mos6507_set_data_bus(cpu, cpu->data);
+    memmap_write(atari);
+    mos6507_set_NZ(cpu, cpu->data);
     END_OPCODE()
     return 0;
 }
 
-int opcode_INX(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_INX(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
+    mos6507 *cpu = &atari->cpu;
     uint8_t value = 0;
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_get_register(MOS6507_REG_X, &value);
+            mos6507_get_register(cpu, MOS6507_REG_X, &value);
             value++;
-            mos6507_set_register(MOS6507_REG_X, value);
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(value & 0xFF));
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (value & 0x80));
+            mos6507_set_register(cpu, MOS6507_REG_X, value);
+            mos6507_set_NZ(cpu, value);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -944,19 +519,19 @@ int opcode_INX(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_INY(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_INY(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
+    mos6507 *cpu = &atari->cpu;
     uint8_t value = 0;
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_get_register(MOS6507_REG_Y, &value);
+            mos6507_get_register(cpu, MOS6507_REG_Y, &value);
             value++;
-            mos6507_set_register(MOS6507_REG_Y, value);
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(value & 0xFF));
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (value & 0x80));
+            mos6507_set_register(cpu, MOS6507_REG_Y, value);
+            mos6507_set_NZ(cpu, value);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -967,22 +542,23 @@ int opcode_INY(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_JMP(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_JMP(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh = 0;
+    mos6507 *cpu = &atari->cpu;
+
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_increment_PC();
-            mos6507_set_address_bus(mos6507_get_PC());
-            memmap_read(&adl);
+            mos6507_increment_PC(cpu);
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
+            memmap_read(atari, &cpu->adl);
             return -1;
         case 2:
-            mos6507_increment_PC();
-            mos6507_set_address_bus(mos6507_get_PC());
-            memmap_read(&adh);
+            mos6507_increment_PC(cpu);
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
+            memmap_read(atari, &cpu->adh);
             return -1;
             /* Intentional fall-through */
         default:
@@ -990,14 +566,15 @@ int opcode_JMP(int cycle, addressing_mode_t address_mode)
             break;
     }
 
-    mos6507_set_PC_hl(adh, adl);
-    mos6507_set_address_bus_hl(adh, adl);
+    mos6507_set_PC_hl(cpu, cpu->adh, cpu->adl);
+    mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl);
     return 0;
 }
 
-int opcode_JSR(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_JSR(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, pcl, pch, S = 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t S = 0;
     uint16_t address = 0;
 
     switch(cycle) {
@@ -1005,80 +582,77 @@ int opcode_JSR(int cycle, addressing_mode_t address_mode)
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_increment_PC();
-            mos6507_set_address_bus(mos6507_get_PC());
-            memmap_read(&adl);
+            mos6507_increment_PC(cpu);
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
+            memmap_read(atari, &cpu->adl);
             return -1;
         case 2:
-            mos6507_get_register(MOS6507_REG_S, &S);
-            mos6507_set_address_bus_hl(STACK_PAGE, S);
+            mos6507_get_register(cpu, MOS6507_REG_S, &S);
+            mos6507_set_address_bus_hl(cpu, STACK_PAGE, S);
             return -1;
         case 3:
-            pch = (uint8_t)(mos6507_get_PC() >> 8);
-            mos6507_push_stack(pch);
+            cpu->pch = (uint8_t)(mos6507_get_PC(cpu) >> 8);
+            mos6507_push_stack(atari, cpu->pch);
             return -1;
         case 4:
-            pcl = (uint8_t)mos6507_get_PC();
-            mos6507_push_stack(pcl);
+            cpu->pcl = (uint8_t)mos6507_get_PC(cpu);
+            mos6507_push_stack(atari, cpu->pcl);
             return -1;
         case 5:
-            mos6507_increment_PC();
-            mos6507_set_address_bus(mos6507_get_PC());
-            memmap_read(&adh);
+            mos6507_increment_PC(cpu);
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
+            memmap_read(atari, &cpu->adh);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
             break;
     }
-    mos6507_set_address_bus_hl(adh, adl);
-    mos6507_set_PC_hl(adh, adl);
+    mos6507_set_address_bus_hl(cpu, cpu->adh, cpu->adl);
+    mos6507_set_PC_hl(cpu, cpu->adh, cpu->adl);
 
     return 0;
 }
 
-int opcode_LDA(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_LDA(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bah, bal, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     FETCH_DATA()
 
-    mos6507_set_register(MOS6507_REG_A, data);
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(data & 0xFF));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (data & 0x80));
+    mos6507_set_register(cpu, MOS6507_REG_A, cpu->data);
+    mos6507_set_NZ(cpu, cpu->data);
     END_OPCODE()
     return 0;
 }
 
-int opcode_LDX(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_LDX(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bah, bal, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     FETCH_DATA()
-    mos6507_set_register(MOS6507_REG_X, data);
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(data & 0xFF));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (data & 0x80));
+    mos6507_set_register(cpu, MOS6507_REG_X, cpu->data);
+    mos6507_set_NZ(cpu, cpu->data);
     END_OPCODE()
     return 0;
 }
 
-int opcode_LDY(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_LDY(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bah, bal, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     FETCH_DATA()
-    mos6507_set_register(MOS6507_REG_Y, data);
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(data & 0xFF));
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (data & 0x80));
+    mos6507_set_register(cpu, MOS6507_REG_Y, cpu->data);
+    mos6507_set_NZ(cpu, cpu->data);
     END_OPCODE()
     return 0;
 }
 
-int opcode_LSR(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_LSR(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bah, bal, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     if (OPCODE_ADDRESSING_MODE_ACCUMULATOR == address_mode) {
@@ -1087,7 +661,7 @@ int opcode_LSR(int cycle, addressing_mode_t address_mode)
                 /* Consume clock cycle for fetching op-code */
                 return -1;
             case 1:
-                mos6507_LSR_Accumulator();
+                mos6507_LSR_Accumulator(cpu);
                 /* Intentional fall-through */
             default:
                 /* End of op-code execution */
@@ -1098,13 +672,23 @@ int opcode_LSR(int cycle, addressing_mode_t address_mode)
     }
 
     FETCH_DATA()
-    mos6507_LSR(&data);
+    mos6507_LSR(cpu, &cpu->data);
     END_OPCODE()
     return 0;
 }
 
-int opcode_NOP(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_NOP(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    /* The undocumented NOPs still read the operand they address */
+    if (OPCODE_ADDRESSING_MODE_IMPLIED != address_mode) {
+        FETCH_DATA()
+        END_OPCODE()
+        return 0;
+    }
+
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
@@ -1120,32 +704,23 @@ int opcode_NOP(int cycle, addressing_mode_t address_mode)
 }
 
 
-int opcode_ORA(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_ORA(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bal, bah, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     FETCH_DATA()
-    mos6507_ORA(&data);
+    mos6507_ORA(cpu, &cpu->data);
     END_OPCODE()
     return 0;
 }
 
 
-int opcode_TSB(int cycle, addressing_mode_t address_mode)
-{
-    static uint8_t adl, adh, ial, bal, bah, data = 0;
-    uint8_t X, Y, c = 0;
 
-    FETCH_DATA()
-    mos6507_TSB(&data);
-    END_OPCODE()
-    return 0;
-}
-
-int opcode_PHA(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_PHA(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t value, S = 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t value, S = 0;
 
     switch(cycle) {
         case 0:
@@ -1153,26 +728,27 @@ int opcode_PHA(int cycle, addressing_mode_t address_mode)
             return -1;
         case 1:
             /* Consume another clock cycle incrementing PC */
-            mos6507_increment_PC();
-            mos6507_set_address_bus(mos6507_get_PC());
+            mos6507_increment_PC(cpu);
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
             return -1;
         case 2:
             /* Fetch value of Accumulator register and stack pointer */
-            mos6507_get_register(MOS6507_REG_A, &value);
-            mos6507_push_stack(value);
+            mos6507_get_register(cpu, MOS6507_REG_A, &value);
+            mos6507_push_stack(atari, value);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
             break;
     }
-    mos6507_set_address_bus(mos6507_get_PC());
+    mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
 
     return 0;
 }
 
-int opcode_PHP(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_PHP(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t value, S= 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t value, S = 0;
 
     switch(cycle) {
         case 0:
@@ -1180,86 +756,87 @@ int opcode_PHP(int cycle, addressing_mode_t address_mode)
             return -1;
         case 1:
             /* Consume another clock cycle incrementing PC */
-            mos6507_increment_PC();
-            mos6507_set_address_bus(mos6507_get_PC());
+            mos6507_increment_PC(cpu);
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
             return -1;
         case 2:
-            /* Fetch value of status register and stack pointer */
-            mos6507_get_register(MOS6507_REG_P, &value);
-            mos6507_push_stack(value);
+            /* The break flag and unused bit 5 always read as set when pushed */
+            mos6507_get_register(cpu, MOS6507_REG_P, &value);
+            mos6507_push_stack(atari, value | MOS6507_STATUS_FLAG_BREAK | 0x20);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
             break;
     }
 
-    mos6507_set_address_bus(mos6507_get_PC());
+    mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
     return 0;
 }
 
-int opcode_PLA(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_PLA(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t value, source = 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t value, source = 0;
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
             /* Consume another clock cycle incrementing PC */
-            mos6507_increment_PC();
-            mos6507_set_address_bus(mos6507_get_PC());
+            mos6507_increment_PC(cpu);
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
             return -1;
         case 2:
-            mos6507_get_register(MOS6507_REG_S, &source);
-            mos6507_set_address_bus_hl(STACK_PAGE, source);
+            mos6507_get_register(cpu, MOS6507_REG_S, &source);
+            mos6507_set_address_bus_hl(cpu, STACK_PAGE, source);
             return -1;
         case 3:
-            mos6507_pull_stack(&value);
-            mos6507_set_register(MOS6507_REG_A, value);
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (value & 0x80));
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(value & 0xFF));
+            mos6507_pull_stack(atari, &value);
+            mos6507_set_register(cpu, MOS6507_REG_A, value);
+            mos6507_set_NZ(cpu, value);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
             break;
     }
 
-    mos6507_set_address_bus(mos6507_get_PC());
+    mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
     return 0;
 }
 
-int opcode_PLP(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_PLP(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t value, source = 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t value, source = 0;
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
             /* Consume another clock cycle incrementing PC */
-            mos6507_increment_PC();
-            mos6507_set_address_bus(mos6507_get_PC());
+            mos6507_increment_PC(cpu);
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
             return -1;
         case 2:
-            mos6507_get_register(MOS6507_REG_S, &source);
-            mos6507_set_address_bus_hl(STACK_PAGE, source);
+            mos6507_get_register(cpu, MOS6507_REG_S, &source);
+            mos6507_set_address_bus_hl(cpu, STACK_PAGE, source);
             return -1;
         case 3:
-            mos6507_pull_stack(&value);
-            mos6507_set_register(MOS6507_REG_P, value);
+            mos6507_pull_stack(atari, &value);
+            mos6507_set_register(cpu, MOS6507_REG_P, value);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
             break;
     }
 
-    mos6507_set_address_bus(mos6507_get_PC());
+    mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
     return 0;
 }
 
-int opcode_ROL(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_ROL(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bal, bah, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     if (OPCODE_ADDRESSING_MODE_ACCUMULATOR == address_mode) {
@@ -1268,7 +845,7 @@ int opcode_ROL(int cycle, addressing_mode_t address_mode)
                 /* Consume clock cycle for fetching op-code */
                 return -1;
             case 1:
-                mos6507_ROL_Accumulator();
+                mos6507_ROL_Accumulator(cpu);
                 /* Intentional fall-through */
             default:
                 /* End of op-code execution */
@@ -1279,14 +856,14 @@ int opcode_ROL(int cycle, addressing_mode_t address_mode)
     }
 
     FETCH_DATA()
-    mos6507_ROL(&data);
+    mos6507_ROL(cpu, &cpu->data);
     END_OPCODE()
     return 0;
 }
 
-int opcode_ROR(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_ROR(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bah, bal, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     if (OPCODE_ADDRESSING_MODE_ACCUMULATOR == address_mode) {
@@ -1295,7 +872,7 @@ int opcode_ROR(int cycle, addressing_mode_t address_mode)
                 /* Consume clock cycle for fetching op-code */
                 return -1;
             case 1:
-                mos6507_ROR_Accumulator();
+                mos6507_ROR_Accumulator(cpu);
                 /* Intentional fall-through */
             default:
                 /* End of op-code execution */
@@ -1306,38 +883,39 @@ int opcode_ROR(int cycle, addressing_mode_t address_mode)
     }
 
     FETCH_DATA()
-    mos6507_ROR(&data);
+    mos6507_ROR(cpu, &cpu->data);
     END_OPCODE()
     return 0;
 }
 
-int opcode_RTI(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_RTI(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t pcl, pch, S, nuS = 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t S, nuS = 0;
 
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_increment_PC();
-            mos6507_set_address_bus(mos6507_get_PC());
+            mos6507_increment_PC(cpu);
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
             return -1;
         case 2:
-            mos6507_get_register(MOS6507_REG_S, &S);
-            mos6507_set_address_bus_hl(STACK_PAGE, S);
+            mos6507_get_register(cpu, MOS6507_REG_S, &S);
+            mos6507_set_address_bus_hl(cpu, STACK_PAGE, S);
             return -1;
         case 3:
-            mos6507_pull_stack(&nuS);
-            mos6507_set_register(MOS6507_REG_S, nuS);
+            mos6507_pull_stack(atari, &nuS);
+            mos6507_set_register(cpu, MOS6507_REG_S, nuS);
             return -1;
         case 4:
-            mos6507_pull_stack(&pcl);
+            mos6507_pull_stack(atari, &cpu->pcl);
             return -1;
         case 5:
-            mos6507_pull_stack(&pch);
-            mos6507_set_PC_hl(pch, pcl);
-            mos6507_set_address_bus_hl(pch, pcl);
+            mos6507_pull_stack(atari, &cpu->pch);
+            mos6507_set_PC_hl(cpu, cpu->pch, cpu->pcl);
+            mos6507_set_address_bus_hl(cpu, cpu->pch, cpu->pcl);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -1346,35 +924,36 @@ int opcode_RTI(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_RTS(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_RTS(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t pcl, pch, S = 0;
+    mos6507 *cpu = &atari->cpu;
+    uint8_t S = 0;
 
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_increment_PC();
-            mos6507_set_address_bus(mos6507_get_PC());
+            mos6507_increment_PC(cpu);
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
             return -1;
         case 2:
-            mos6507_get_register(MOS6507_REG_S, &S);
-            mos6507_set_address_bus_hl(STACK_PAGE, S);
+            mos6507_get_register(cpu, MOS6507_REG_S, &S);
+            mos6507_set_address_bus_hl(cpu, STACK_PAGE, S);
             return -1;
         case 3:
-            mos6507_pull_stack(&pcl);
+            mos6507_pull_stack(atari, &cpu->pcl);
             return -1;
         case 4:
-            mos6507_pull_stack(&pch);
+            mos6507_pull_stack(atari, &cpu->pch);
             return -1;
         case 5:
-            mos6507_set_PC_hl(pch, pcl);
-            mos6507_set_address_bus_hl(pch, pcl);
+            mos6507_set_PC_hl(cpu, cpu->pch, cpu->pcl);
+            mos6507_set_address_bus_hl(cpu, cpu->pch, cpu->pcl);
             // TODO: Review if this is actually necessary for maintaining 
             // subroutine consistency
-            mos6507_increment_PC();
-            mos6507_set_address_bus(mos6507_get_PC());
+            mos6507_increment_PC(cpu);
+            mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -1385,25 +964,27 @@ int opcode_RTS(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_SBC(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_SBC(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, ial, bal, bah, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     FETCH_DATA()
-    mos6507_SBC(data);
+    mos6507_SBC(cpu, cpu->data);
     END_OPCODE()
     return 0;
 }
 
-int opcode_SEC(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_SEC(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
+    mos6507 *cpu = &atari->cpu;
+
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_CARRY, 1);
+            mos6507_set_status_flag(cpu, MOS6507_STATUS_FLAG_CARRY, 1);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -1414,14 +995,16 @@ int opcode_SEC(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_SED(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_SED(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
+    mos6507 *cpu = &atari->cpu;
+
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_DECIMAL, 1);
+            mos6507_set_status_flag(cpu, MOS6507_STATUS_FLAG_DECIMAL, 1);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -1432,14 +1015,16 @@ int opcode_SED(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_SEI(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_SEI(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
+    mos6507 *cpu = &atari->cpu;
+
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_INTERRUPT, 1);
+            mos6507_set_status_flag(cpu, MOS6507_STATUS_FLAG_INTERRUPT, 1);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -1450,57 +1035,57 @@ int opcode_SEI(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_STA(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_STA(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, bah, bal, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     FETCH_STORE_ADDRESS()
-    mos6507_get_register(MOS6507_REG_A, &data);
-    mos6507_set_data_bus(data);
-    memmap_write();
+    mos6507_get_register(cpu, MOS6507_REG_A, &cpu->data);
+    mos6507_set_data_bus(cpu, cpu->data);
+    memmap_write(atari);
     END_OPCODE()
     return 0;
 }
 
-int opcode_STX(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_STX(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, bah, bal, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     FETCH_STORE_ADDRESS()
-    mos6507_get_register(MOS6507_REG_X, &data);
-    mos6507_set_data_bus(data);
-    memmap_write();
+    mos6507_get_register(cpu, MOS6507_REG_X, &cpu->data);
+    mos6507_set_data_bus(cpu, cpu->data);
+    memmap_write(atari);
     END_OPCODE()
     return 0;
 }
 
-int opcode_STY(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_STY(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
-    static uint8_t adl, adh, bah, bal, data = 0;
+    mos6507 *cpu = &atari->cpu;
     uint8_t X, Y, c = 0;
 
     FETCH_STORE_ADDRESS()
-    mos6507_get_register(MOS6507_REG_Y, &data);
-    mos6507_set_data_bus(data);
-    memmap_write();
+    mos6507_get_register(cpu, MOS6507_REG_Y, &cpu->data);
+    mos6507_set_data_bus(cpu, cpu->data);
+    memmap_write(atari);
     END_OPCODE()
     return 0;
 }
 
-int opcode_TAX(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_TAX(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
+    mos6507 *cpu = &atari->cpu;
     uint8_t value = 0;
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_get_register(MOS6507_REG_A, &value);
-            mos6507_set_register(MOS6507_REG_X, value);
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(value & 0xFF));
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (value & 0x80));
+            mos6507_get_register(cpu, MOS6507_REG_A, &value);
+            mos6507_set_register(cpu, MOS6507_REG_X, value);
+            mos6507_set_NZ(cpu, value);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -1511,18 +1096,18 @@ int opcode_TAX(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_TAY(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_TAY(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
+    mos6507 *cpu = &atari->cpu;
     uint8_t value = 0;
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_get_register(MOS6507_REG_A, &value);
-            mos6507_set_register(MOS6507_REG_Y, value);
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(value & 0xFF));
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (value & 0x80));
+            mos6507_get_register(cpu, MOS6507_REG_A, &value);
+            mos6507_set_register(cpu, MOS6507_REG_Y, value);
+            mos6507_set_NZ(cpu, value);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -1533,18 +1118,18 @@ int opcode_TAY(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_TSX(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_TSX(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
+    mos6507 *cpu = &atari->cpu;
     uint8_t value = 0;
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_get_register(MOS6507_REG_S, &value);
-            mos6507_set_register(MOS6507_REG_X, value);
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(value & 0xFF));
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (value & 0x80));
+            mos6507_get_register(cpu, MOS6507_REG_S, &value);
+            mos6507_set_register(cpu, MOS6507_REG_X, value);
+            mos6507_set_NZ(cpu, value);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -1555,18 +1140,18 @@ int opcode_TSX(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_TXA(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_TXA(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
+    mos6507 *cpu = &atari->cpu;
     uint8_t value = 0;
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_get_register(MOS6507_REG_X, &value);
-            mos6507_set_register(MOS6507_REG_A, value);
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(value & 0xFF));
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (value & 0x80));
+            mos6507_get_register(cpu, MOS6507_REG_X, &value);
+            mos6507_set_register(cpu, MOS6507_REG_A, value);
+            mos6507_set_NZ(cpu, value);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -1577,16 +1162,17 @@ int opcode_TXA(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_TXS(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_TXS(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
+    mos6507 *cpu = &atari->cpu;
     uint8_t value = 0;
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_get_register(MOS6507_REG_X, &value);
-            mos6507_set_register(MOS6507_REG_S, value);
+            mos6507_get_register(cpu, MOS6507_REG_X, &value);
+            mos6507_set_register(cpu, MOS6507_REG_S, value);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -1597,18 +1183,18 @@ int opcode_TXS(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
-int opcode_TYA(int cycle, addressing_mode_t address_mode)
+OPCODE_INLINE int opcode_TYA(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
 {
+    mos6507 *cpu = &atari->cpu;
     uint8_t value = 0;
     switch(cycle) {
         case 0:
             /* Consume clock cycle for fetching op-code */
             return -1;
         case 1:
-            mos6507_get_register(MOS6507_REG_Y, &value);
-            mos6507_set_register(MOS6507_REG_A, value);
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_ZERO, !(value & 0xFF));
-            mos6507_set_status_flag(MOS6507_STATUS_FLAG_NEGATIVE, (value & 0x80));
+            mos6507_get_register(cpu, MOS6507_REG_Y, &value);
+            mos6507_set_register(cpu, MOS6507_REG_A, value);
+            mos6507_set_NZ(cpu, value);
             /* Intentional fall-through */
         default:
             /* End of op-code execution */
@@ -1619,3 +1205,607 @@ int opcode_TYA(int cycle, addressing_mode_t address_mode)
     return 0;
 }
 
+/******************************************************************************
+ * Undocumented op-codes
+ *****************************************************************************/
+
+/* The unstable stores AND their value with the high byte of the base
+ * address plus one. When indexing carried into the high byte, that is
+ * replaced by the value as well.
+ */
+static void opcode_store_high(atari2600_t *atari, uint8_t value, uint8_t carry)
+{
+    mos6507 *cpu = &atari->cpu;
+
+    cpu->data = value & (cpu->bah + 1);
+    if (carry) {
+        mos6507_set_address_bus_hl(cpu, cpu->data, cpu->adl);
+    }
+    mos6507_set_data_bus(cpu, cpu->data);
+    memmap_write(atari);
+}
+
+OPCODE_INLINE int opcode_LAX(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_DATA()
+    mos6507_LAX(cpu, cpu->data);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_SAX(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_STORE_ADDRESS()
+    cpu->data = cpu->A & cpu->X;
+    mos6507_set_data_bus(cpu, cpu->data);
+    memmap_write(atari);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_SLO(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_DATA()
+    mos6507_SLO(cpu, &cpu->data);
+    mos6507_set_data_bus(cpu, cpu->data);
+    memmap_write(atari);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_RLA(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_DATA()
+    mos6507_RLA(cpu, &cpu->data);
+    mos6507_set_data_bus(cpu, cpu->data);
+    memmap_write(atari);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_SRE(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_DATA()
+    mos6507_SRE(cpu, &cpu->data);
+    mos6507_set_data_bus(cpu, cpu->data);
+    memmap_write(atari);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_RRA(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_DATA()
+    mos6507_RRA(cpu, &cpu->data);
+    mos6507_set_data_bus(cpu, cpu->data);
+    memmap_write(atari);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_DCP(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_DATA()
+    mos6507_DCP(cpu, &cpu->data);
+    mos6507_set_data_bus(cpu, cpu->data);
+    memmap_write(atari);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_ISB(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_DATA()
+    mos6507_ISB(cpu, &cpu->data);
+    mos6507_set_data_bus(cpu, cpu->data);
+    memmap_write(atari);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_ANC(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_DATA()
+    mos6507_ANC(cpu, cpu->data);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_ALR(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_DATA()
+    mos6507_ALR(cpu, cpu->data);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_ARR(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_DATA()
+    mos6507_ARR(cpu, cpu->data);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_SBX(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_DATA()
+    mos6507_SBX(cpu, cpu->data);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_ANE(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_DATA()
+    mos6507_ANE(cpu, cpu->data);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_LXA(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_DATA()
+    mos6507_LXA(cpu, cpu->data);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_LAS(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_DATA()
+    mos6507_LAS(cpu, cpu->data);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_SHA(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_STORE_ADDRESS()
+    opcode_store_high(atari, cpu->A & cpu->X, c);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_SHX(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_STORE_ADDRESS()
+    opcode_store_high(atari, cpu->X, c);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_SHY(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_STORE_ADDRESS()
+    opcode_store_high(atari, cpu->Y, c);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_TAS(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    mos6507 *cpu = &atari->cpu;
+    uint8_t X, Y, c = 0;
+
+    FETCH_STORE_ADDRESS()
+    cpu->S = cpu->A & cpu->X;
+    opcode_store_high(atari, cpu->S, c);
+    END_OPCODE()
+    return 0;
+}
+
+OPCODE_INLINE int opcode_JAM(atari2600_t *atari, int cycle, addressing_mode_t address_mode)
+{
+    /* The CPU stops fetching until it is reset, so it never completes */
+    return OPCODE_HALTED;
+}
+
+/******************************************************************************
+ * Instruction table
+ *
+ * Every op-code with the handler and addressing mode it runs with. Each
+ * line expands into a handler specialised for that op-code and its entry
+ * in the table, so both are fixed at compile time.
+ *****************************************************************************/
+
+#define ISA_OPCODES(X) \
+    /* The documented codes supported by a real 6507 */ \
+    /* 0x00: BRK, Implied */ \
+    X(0x00, BRK, IMPLIED) \
+    /* Load accumulator with memory */ \
+    X(0xA9, LDA, IMMEDIATE) \
+    X(0xA5, LDA, ZERO_PAGE) \
+    X(0xB5, LDA, ZERO_PAGE_X_INDEXED) \
+    X(0xAD, LDA, ABSOLUTE) \
+    X(0xBD, LDA, ABSOLUTE_X_INDEXED) \
+    X(0xB9, LDA, ABSOLUTE_Y_INDEXED) \
+    X(0xA1, LDA, INDIRECT_X_INDEXED) \
+    X(0xB1, LDA, INDIRECT_Y_INDEXED) \
+    /* Load Index X with memory */ \
+    X(0xA2, LDX, IMMEDIATE) \
+    X(0xA6, LDX, ZERO_PAGE) \
+    X(0xB6, LDX, ZERO_PAGE_Y_INDEXED) \
+    X(0xAE, LDX, ABSOLUTE) \
+    X(0xBE, LDX, ABSOLUTE_Y_INDEXED) \
+    /* Load Index Y with memory */ \
+    X(0xA0, LDY, IMMEDIATE) \
+    X(0xA4, LDY, ZERO_PAGE) \
+    X(0xB4, LDY, ZERO_PAGE_X_INDEXED) \
+    X(0xAC, LDY, ABSOLUTE) \
+    X(0xBC, LDY, ABSOLUTE_X_INDEXED) \
+    /* Store Accumulator in memory */ \
+    X(0x85, STA, ZERO_PAGE) \
+    X(0x95, STA, ZERO_PAGE_X_INDEXED) \
+    X(0x8D, STA, ABSOLUTE) \
+    X(0x9D, STA, ABSOLUTE_X_INDEXED) \
+    X(0x99, STA, ABSOLUTE_Y_INDEXED) \
+    X(0x81, STA, INDIRECT_X_INDEXED) \
+    X(0x91, STA, INDIRECT_Y_INDEXED) \
+    /* Store Index X in memory */ \
+    X(0x86, STX, ZERO_PAGE) \
+    X(0x96, STX, ZERO_PAGE_Y_INDEXED) \
+    X(0x8E, STX, ABSOLUTE) \
+    /* Store Index Y in memory */ \
+    X(0x84, STY, ZERO_PAGE) \
+    X(0x94, STY, ZERO_PAGE_X_INDEXED) \
+    X(0x8C, STY, ABSOLUTE) \
+    /* Add memory to Accumulator with carry */ \
+    X(0x69, ADC, IMMEDIATE) \
+    X(0x65, ADC, ZERO_PAGE) \
+    X(0x75, ADC, ZERO_PAGE_X_INDEXED) \
+    X(0x6D, ADC, ABSOLUTE) \
+    X(0x7D, ADC, ABSOLUTE_X_INDEXED) \
+    X(0x79, ADC, ABSOLUTE_Y_INDEXED) \
+    X(0x61, ADC, INDIRECT_X_INDEXED) \
+    X(0x71, ADC, INDIRECT_Y_INDEXED) \
+    /* Subtract memory from Accumulator with borrow */ \
+    X(0xE9, SBC, IMMEDIATE) \
+    X(0xE5, SBC, ZERO_PAGE) \
+    X(0xF5, SBC, ZERO_PAGE_X_INDEXED) \
+    X(0xED, SBC, ABSOLUTE) \
+    X(0xFD, SBC, ABSOLUTE_X_INDEXED) \
+    X(0xF9, SBC, ABSOLUTE_Y_INDEXED) \
+    X(0xE1, SBC, INDIRECT_X_INDEXED) \
+    X(0xF1, SBC, INDIRECT_Y_INDEXED) \
+    /* Increment memory by one */ \
+    X(0xE6, INC, ZERO_PAGE) \
+    X(0xF6, INC, ZERO_PAGE_X_INDEXED) \
+    X(0xEE, INC, ABSOLUTE) \
+    X(0xFE, INC, ABSOLUTE_X_INDEXED) \
+    /* Increment Index X by one */ \
+    X(0xE8, INX, IMPLIED) \
+    /* Increment Index Y by one */ \
+    X(0xC8, INY, IMPLIED) \
+    /* Decrement memory by one */ \
+    X(0xC6, DEC, ZERO_PAGE) \
+    X(0xD6, DEC, ZERO_PAGE_X_INDEXED) \
+    X(0xCE, DEC, ABSOLUTE) \
+    X(0xDE, DEC, ABSOLUTE_X_INDEXED) \
+    /* Decrement Index X by one */ \
+    X(0xCA, DEX, IMPLIED) \
+    /* Decrement Index Y by one */ \
+    X(0x88, DEY, IMPLIED) \
+    /* Logical AND with Accumulator */ \
+    X(0x21, AND, INDIRECT_X_INDEXED) \
+    X(0x25, AND, ZERO_PAGE) \
+    X(0x29, AND, IMMEDIATE) \
+    X(0x2D, AND, ABSOLUTE) \
+    X(0x31, AND, INDIRECT_Y_INDEXED) \
+    X(0x35, AND, ZERO_PAGE_X_INDEXED) \
+    X(0x39, AND, ABSOLUTE_Y_INDEXED) \
+    X(0x3D, AND, ABSOLUTE_X_INDEXED) \
+    /* Logical OR with Accumulator */ \
+    X(0x01, ORA, INDIRECT_X_INDEXED) \
+    X(0x05, ORA, ZERO_PAGE) \
+    X(0x09, ORA, IMMEDIATE) \
+    X(0x0D, ORA, ABSOLUTE) \
+    X(0x11, ORA, INDIRECT_Y_INDEXED) \
+    X(0x15, ORA, ZERO_PAGE_X_INDEXED) \
+    X(0x19, ORA, ABSOLUTE_Y_INDEXED) \
+    X(0x1D, ORA, ABSOLUTE_X_INDEXED) \
+    /* logical exclusive OR with Accumulator */ \
+    X(0x41, EOR, INDIRECT_X_INDEXED) \
+    X(0x45, EOR, ZERO_PAGE) \
+    X(0x49, EOR, IMMEDIATE) \
+    X(0x4D, EOR, ABSOLUTE) \
+    X(0x51, EOR, INDIRECT_Y_INDEXED) \
+    X(0x55, EOR, ZERO_PAGE_X_INDEXED) \
+    X(0x59, EOR, ABSOLUTE_Y_INDEXED) \
+    X(0x5D, EOR, ABSOLUTE_X_INDEXED) \
+    /* Jump to new location */ \
+    X(0x4C, JMP, ABSOLUTE) \
+    X(0x6C, JMP, INDIRECT) \
+    /* Branch on carry clear */ \
+    X(0x90, BCC, RELATIVE) \
+    /* Branch on carry set */ \
+    X(0xB0, BCS, RELATIVE) \
+    /* Branch on result zero */ \
+    X(0xF0, BEQ, RELATIVE) \
+    /* Branch on result not zero */ \
+    X(0xD0, BNE, RELATIVE) \
+    /* Branch on result not zero */ \
+    X(0x30, BMI, RELATIVE) \
+    /* Branch on result plus */ \
+    X(0x10, BPL, RELATIVE) \
+    /* Branch on overflow set */ \
+    X(0x70, BVS, RELATIVE) \
+    /* Branch on overflow clear */ \
+    X(0x50, BVC, RELATIVE) \
+    /* Compare with Accumulator*/ \
+    X(0xC9, CMP, IMMEDIATE) \
+    X(0xC5, CMP, ZERO_PAGE) \
+    X(0xD5, CMP, ZERO_PAGE_X_INDEXED) \
+    X(0xCD, CMP, ABSOLUTE) \
+    X(0xDD, CMP, ABSOLUTE_X_INDEXED) \
+    X(0xD9, CMP, ABSOLUTE_Y_INDEXED) \
+    X(0xC1, CMP, INDIRECT_X_INDEXED) \
+    X(0xD1, CMP, INDIRECT_Y_INDEXED) \
+    /* Compare memory with Index X */ \
+    X(0xE0, CPX, IMMEDIATE) \
+    X(0xE4, CPX, ZERO_PAGE) \
+    X(0xEC, CPX, ABSOLUTE) \
+    /* Compare memory with Index Y */ \
+    X(0xC0, CPY, IMMEDIATE) \
+    X(0xC4, CPY, ZERO_PAGE) \
+    X(0xCC, CPY, ABSOLUTE) \
+    /* Test bits in memory with Accumulator */ \
+    X(0x24, BIT, ZERO_PAGE) \
+    X(0x2C, BIT, ABSOLUTE) \
+    /* Shift left one bit */ \
+    X(0x0A, ASL, ACCUMULATOR) \
+    X(0x06, ASL, ZERO_PAGE) \
+    X(0x16, ASL, ZERO_PAGE_X_INDEXED) \
+    X(0x0E, ASL, ABSOLUTE) \
+    X(0x1E, ASL, ABSOLUTE_X_INDEXED) \
+    /* Right shift one bit */ \
+    X(0x4A, LSR, ACCUMULATOR) \
+    X(0x46, LSR, ZERO_PAGE) \
+    X(0x56, LSR, ZERO_PAGE_X_INDEXED) \
+    X(0x4E, LSR, ABSOLUTE) \
+    X(0x5E, LSR, ABSOLUTE_X_INDEXED) \
+    /* Rotate one bit left */ \
+    X(0x2A, ROL, ACCUMULATOR) \
+    X(0x26, ROL, ZERO_PAGE) \
+    X(0x36, ROL, ZERO_PAGE_X_INDEXED) \
+    X(0x2E, ROL, ABSOLUTE) \
+    X(0x3E, ROL, ABSOLUTE_X_INDEXED) \
+    /* Rotate one bit right */ \
+    X(0x6A, ROR, ACCUMULATOR) \
+    X(0x66, ROR, ZERO_PAGE) \
+    X(0x76, ROR, ZERO_PAGE_X_INDEXED) \
+    X(0x6E, ROR, ABSOLUTE) \
+    X(0x7E, ROR, ABSOLUTE_X_INDEXED) \
+    /* Transfer Accumulator to Index X */ \
+    X(0xAA, TAX, IMPLIED) \
+    /* Transfer Accumulator to Index Y */ \
+    X(0xA8, TAY, IMPLIED) \
+    /* Transfer Index X to Accumulator */ \
+    X(0x8A, TXA, IMPLIED) \
+    /* Transfer Index Y to Accumulator */ \
+    X(0x98, TYA, IMPLIED) \
+    /* Transfer stack pointer to Index X */ \
+    X(0xBA, TSX, IMPLIED) \
+    /* Transfer Index X to stack register */ \
+    X(0x9A, TXS, IMPLIED) \
+    /* Push Accumulator onto stack */ \
+    X(0x48, PHA, IMPLIED) \
+    /* Push processor status onto stack */ \
+    X(0x08, PHP, IMPLIED) \
+    /* Pull Accumulator from stack */ \
+    X(0x68, PLA, IMPLIED) \
+    /* Pull processor status from stack */ \
+    X(0x28, PLP, IMPLIED) \
+    /* Jump to new location saving return address */ \
+    X(0x20, JSR, ABSOLUTE) \
+    /* Return from subroutine */ \
+    X(0x60, RTS, IMPLIED) \
+    /* Return from interrupt */ \
+    X(0x40, RTI, IMPLIED) \
+    /* Clear carry flag */ \
+    X(0x18, CLC, IMPLIED) \
+    /* Clear decimal mode */ \
+    X(0xD8, CLD, IMPLIED) \
+    /* Clear interrupt disable bit */ \
+    X(0x58, CLI, IMPLIED) \
+    /* Clear overflow bit */ \
+    X(0xB8, CLV, IMPLIED) \
+    /* Set carry flag */ \
+    X(0x38, SEC, IMPLIED) \
+    /* Set decimal flag */ \
+    X(0xF8, SED, IMPLIED) \
+    /* Set interrupt disable status */ \
+    X(0x78, SEI, IMPLIED) \
+    /* No operation */ \
+    X(0xEA, NOP, IMPLIED) \
+    /* The undocumented codes which the NMOS part decodes as well */ \
+    /* Shift left then OR with accumulator */ \
+    X(0x07, SLO, ZERO_PAGE) \
+    X(0x17, SLO, ZERO_PAGE_X_INDEXED) \
+    X(0x0F, SLO, ABSOLUTE) \
+    X(0x1F, SLO, ABSOLUTE_X_INDEXED) \
+    X(0x1B, SLO, ABSOLUTE_Y_INDEXED) \
+    X(0x03, SLO, INDIRECT_X_INDEXED) \
+    X(0x13, SLO, INDIRECT_Y_INDEXED) \
+    /* Rotate left then AND with accumulator */ \
+    X(0x27, RLA, ZERO_PAGE) \
+    X(0x37, RLA, ZERO_PAGE_X_INDEXED) \
+    X(0x2F, RLA, ABSOLUTE) \
+    X(0x3F, RLA, ABSOLUTE_X_INDEXED) \
+    X(0x3B, RLA, ABSOLUTE_Y_INDEXED) \
+    X(0x23, RLA, INDIRECT_X_INDEXED) \
+    X(0x33, RLA, INDIRECT_Y_INDEXED) \
+    /* Shift right then exclusive-OR with accumulator */ \
+    X(0x47, SRE, ZERO_PAGE) \
+    X(0x57, SRE, ZERO_PAGE_X_INDEXED) \
+    X(0x4F, SRE, ABSOLUTE) \
+    X(0x5F, SRE, ABSOLUTE_X_INDEXED) \
+    X(0x5B, SRE, ABSOLUTE_Y_INDEXED) \
+    X(0x43, SRE, INDIRECT_X_INDEXED) \
+    X(0x53, SRE, INDIRECT_Y_INDEXED) \
+    /* Rotate right then add to accumulator with carry */ \
+    X(0x67, RRA, ZERO_PAGE) \
+    X(0x77, RRA, ZERO_PAGE_X_INDEXED) \
+    X(0x6F, RRA, ABSOLUTE) \
+    X(0x7F, RRA, ABSOLUTE_X_INDEXED) \
+    X(0x7B, RRA, ABSOLUTE_Y_INDEXED) \
+    X(0x63, RRA, INDIRECT_X_INDEXED) \
+    X(0x73, RRA, INDIRECT_Y_INDEXED) \
+    /* Decrement memory then compare with accumulator */ \
+    X(0xC7, DCP, ZERO_PAGE) \
+    X(0xD7, DCP, ZERO_PAGE_X_INDEXED) \
+    X(0xCF, DCP, ABSOLUTE) \
+    X(0xDF, DCP, ABSOLUTE_X_INDEXED) \
+    X(0xDB, DCP, ABSOLUTE_Y_INDEXED) \
+    X(0xC3, DCP, INDIRECT_X_INDEXED) \
+    X(0xD3, DCP, INDIRECT_Y_INDEXED) \
+    /* Increment memory then subtract from accumulator with borrow */ \
+    X(0xE7, ISB, ZERO_PAGE) \
+    X(0xF7, ISB, ZERO_PAGE_X_INDEXED) \
+    X(0xEF, ISB, ABSOLUTE) \
+    X(0xFF, ISB, ABSOLUTE_X_INDEXED) \
+    X(0xFB, ISB, ABSOLUTE_Y_INDEXED) \
+    X(0xE3, ISB, INDIRECT_X_INDEXED) \
+    X(0xF3, ISB, INDIRECT_Y_INDEXED) \
+    /* Load accumulator and X with memory */ \
+    X(0xA7, LAX, ZERO_PAGE) \
+    X(0xB7, LAX, ZERO_PAGE_Y_INDEXED) \
+    X(0xAF, LAX, ABSOLUTE) \
+    X(0xBF, LAX, ABSOLUTE_Y_INDEXED) \
+    X(0xA3, LAX, INDIRECT_X_INDEXED) \
+    X(0xB3, LAX, INDIRECT_Y_INDEXED) \
+    /* Store accumulator AND X in memory */ \
+    X(0x87, SAX, ZERO_PAGE) \
+    X(0x97, SAX, ZERO_PAGE_Y_INDEXED) \
+    X(0x8F, SAX, ABSOLUTE) \
+    X(0x83, SAX, INDIRECT_X_INDEXED) \
+    /* AND with accumulator, copying bit 7 into carry */ \
+    X(0x0B, ANC, IMMEDIATE) \
+    X(0x2B, ANC, IMMEDIATE) \
+    /* AND with accumulator then shift right */ \
+    X(0x4B, ALR, IMMEDIATE) \
+    /* AND with accumulator then rotate right */ \
+    X(0x6B, ARR, IMMEDIATE) \
+    /* Subtract memory from accumulator AND X, into X */ \
+    X(0xCB, SBX, IMMEDIATE) \
+    /* Subtract memory from accumulator with borrow, as 0xE9 */ \
+    X(0xEB, SBC, IMMEDIATE) \
+    /* No operation, performing the read of the addressing mode */ \
+    X(0x1A, NOP, IMPLIED) \
+    X(0x3A, NOP, IMPLIED) \
+    X(0x5A, NOP, IMPLIED) \
+    X(0x7A, NOP, IMPLIED) \
+    X(0xDA, NOP, IMPLIED) \
+    X(0xFA, NOP, IMPLIED) \
+    X(0x80, NOP, IMMEDIATE) \
+    X(0x82, NOP, IMMEDIATE) \
+    X(0x89, NOP, IMMEDIATE) \
+    X(0xC2, NOP, IMMEDIATE) \
+    X(0xE2, NOP, IMMEDIATE) \
+    X(0x04, NOP, ZERO_PAGE) \
+    X(0x44, NOP, ZERO_PAGE) \
+    X(0x64, NOP, ZERO_PAGE) \
+    X(0x14, NOP, ZERO_PAGE_X_INDEXED) \
+    X(0x34, NOP, ZERO_PAGE_X_INDEXED) \
+    X(0x54, NOP, ZERO_PAGE_X_INDEXED) \
+    X(0x74, NOP, ZERO_PAGE_X_INDEXED) \
+    X(0xD4, NOP, ZERO_PAGE_X_INDEXED) \
+    X(0xF4, NOP, ZERO_PAGE_X_INDEXED) \
+    X(0x0C, NOP, ABSOLUTE) \
+    X(0x1C, NOP, ABSOLUTE_X_INDEXED) \
+    X(0x3C, NOP, ABSOLUTE_X_INDEXED) \
+    X(0x5C, NOP, ABSOLUTE_X_INDEXED) \
+    X(0x7C, NOP, ABSOLUTE_X_INDEXED) \
+    X(0xDC, NOP, ABSOLUTE_X_INDEXED) \
+    X(0xFC, NOP, ABSOLUTE_X_INDEXED) \
+    /* Unstable, depending on the analogue behaviour of the chip */ \
+    X(0x8B, ANE, IMMEDIATE) \
+    X(0xAB, LXA, IMMEDIATE) \
+    X(0xBB, LAS, ABSOLUTE_Y_INDEXED) \
+    X(0x93, SHA, INDIRECT_Y_INDEXED) \
+    X(0x9F, SHA, ABSOLUTE_Y_INDEXED) \
+    X(0x9E, SHX, ABSOLUTE_Y_INDEXED) \
+    X(0x9C, SHY, ABSOLUTE_X_INDEXED) \
+    X(0x9B, TAS, ABSOLUTE_Y_INDEXED) \
+    /* Lock the CPU up until it is reset */ \
+    X(0x02, JAM, IMPLIED) \
+    X(0x12, JAM, IMPLIED) \
+    X(0x22, JAM, IMPLIED) \
+    X(0x32, JAM, IMPLIED) \
+    X(0x42, JAM, IMPLIED) \
+    X(0x52, JAM, IMPLIED) \
+    X(0x62, JAM, IMPLIED) \
+    X(0x72, JAM, IMPLIED) \
+    X(0x92, JAM, IMPLIED) \
+    X(0xB2, JAM, IMPLIED) \
+    X(0xD2, JAM, IMPLIED) \
+    X(0xF2, JAM, IMPLIED) \
+
+#define OPCODE_SPECIALISE(_opcode, _name, _mode) \
+    static int opcode_##_opcode(atari2600_t *atari, int cycle) \
+    { \
+        return opcode_##_name(atari, cycle, OPCODE_ADDRESSING_MODE_##_mode); \
+    }
+
+#define OPCODE_ENTRY(_opcode, _name, _mode) \
+    [_opcode] = { opcode_##_opcode, OPCODE_ADDRESSING_MODE_##_mode },
+
+ISA_OPCODES(OPCODE_SPECIALISE)
+
+const instruction_t ISA_TABLE_SECTION ISA_table[ISA_LENGTH] = {
+    ISA_OPCODES(OPCODE_ENTRY)
+};
@@ -6,58 +6,61 @@
  * Provides implementations of the 6507 model.
  */
 
+#include "../atari/Atari-2600.h"
 #include "../atari/Atari-memmap.h"
 #ifdef PRINT_STATE
     #include "../test/debug.h"
 #endif
 #include "mos6507.h"
 
-/* Representation of our CPU */
-static mos6507 cpu = {0};
-
 /* Invoking this function causes the state of the CPU to update
  * as if receiving an external clock tick. Note that the 6507
  * required at least two clock cycles to execute an opcode, usually
  * more depending on the memory addressing mode invoked.
  */
-int mos6507_clock_tick(void)
+int mos6507_clock_tick(atari2600_t *atari)
 {
+    mos6507 *cpu = &atari->cpu;
+    int cycle;
+
     /* If the CPU is still in the middle of decoding/executing an
      * operation then continue execution. Otherwise, read the next 
-     * opcode out of memory and begin decode.
+     * opcode out of memory and begin decode. The clock rather than the
+     * op-code says which, as BRK's op-code is 0.
      */
-    if (!cpu.current_instruction) {
-        memmap_read(&cpu.current_instruction);
+    if (!cpu->current_clock) {
+        memmap_read(atari, &cpu->current_instruction);
     }
-    if (opcode_validate(cpu.current_instruction)) {
 #ifdef PRINT_STATE
-        debug_print_illegal_opcode(cpu.current_instruction);
+    debug_print_execution_step(atari);
 #endif
-        return -1;
-    }
+
+    /* Every op-code has a handler, so only a JAM stops the CPU */
+    cycle = opcode_execute(atari);
+    if (cycle < 0) {
 #ifdef PRINT_STATE
-    debug_print_execution_step();
+        debug_print_illegal_opcode(atari, cpu->current_instruction);
 #endif
-
-    cpu.current_clock = opcode_execute(cpu.current_instruction);
-
-    if(!cpu.current_clock) {
-        cpu.current_instruction = 0;
+        return -1;
+    }
+    if (!cycle) {
+        cpu->current_instruction = 0;
     }
     return 0;
 }
 
-void mos6507_reset(void)
+void mos6507_reset(atari2600_t *atari)
 {
+    mos6507 *cpu = &atari->cpu;
     uint8_t pch, pcl = 0;
     uint16_t pc = 0;
 
     /* Clear model representations */
-    mos6507_init();
+    mos6507_init(cpu);
     /* The interrupt disable flag is set by default to prevent spurious IRQ
      * while external circuitry is settling after power reset.
      */
-    mos6507_set_status_flag(MOS6507_STATUS_FLAG_INTERRUPT, 1);
+    mos6507_set_status_flag(cpu, MOS6507_STATUS_FLAG_INTERRUPT, 1);
 
     /* Now proceed through the 6507's regular startup sequence.
      * 1. Jump to reset vector 0xFFFC, read that byte as the 
@@ -70,10 +73,10 @@ void mos6507_reset(void)
      * just a few bytes in length.
      */
 
-    mos6507_set_address_bus(0xFFFC);
-    memmap_read(&pcl);
-    mos6507_set_address_bus(0xFFFD);
-    memmap_read(&pch);
+    mos6507_set_address_bus(cpu, 0xFFFC);
+    memmap_read(atari, &pcl);
+    mos6507_set_address_bus(cpu, 0xFFFD);
+    memmap_read(atari, &pch);
 
     /* Pack the two bytes found at the reset vector into 
      * the program counter and initialise it as the true
@@ -82,98 +85,71 @@ void mos6507_reset(void)
     pc |= (pch << 8);
     pc |= pcl;
 
-    mos6507_set_PC(pc);
-    mos6507_set_address_bus(mos6507_get_PC());
+    mos6507_set_PC(cpu, pc);
+    mos6507_set_address_bus(cpu, mos6507_get_PC(cpu));
 }
 
-void mos6507_init(void)
+void mos6507_init(mos6507 *cpu)
 {
     /* Initialise all members back to 0 */
-    cpu.A =  0;
-    cpu.Y =  0;
-    cpu.X =  0;
-    cpu.PC = 0;
-    cpu.S =  0xFD;
-    cpu.P =  0;
-    cpu.data_bus = 0;
-    cpu.address_bus = 0;
-    cpu.current_instruction = 0;
-    cpu.current_clock = 0;
+    cpu->A =  0;
+    cpu->Y =  0;
+    cpu->X =  0;
+    cpu->PC = 0;
+    cpu->S =  0xFD;
+    cpu->P =  0;
+    cpu->N =  0;
+    cpu->Z =  1;
+    cpu->C =  0;
+    cpu->V =  0;
+    cpu->data_bus = 0;
+    cpu->address_bus = 0;
+    cpu->current_instruction = 0;
+    cpu->current_clock = 0;
+    cpu->adl = 0;
+    cpu->adh = 0;
+    cpu->bal = 0;
+    cpu->bah = 0;
+    cpu->ial = 0;
+    cpu->data = 0;
+    cpu->offset = 0;
+    cpu->addr = 0;
+    cpu->pcl = 0;
+    cpu->pch = 0;
 }
 
-void mos6507_set_register(mos6507_register_t reg, uint8_t value)
+void mos6507_set_PC_hl(mos6507 *cpu, uint8_t pch, uint8_t pcl)
 {
-    switch(reg) {
-        case MOS6507_REG_A:  cpu.A  = value; break;
-        case MOS6507_REG_Y:  cpu.Y  = value; break;
-        case MOS6507_REG_X:  cpu.X  = value; break;
-        case MOS6507_REG_PC: cpu.PC = value; break;
-        case MOS6507_REG_S:  cpu.S  = value; break;
-        case MOS6507_REG_P:  cpu.P  = value; break;
-        default: /* Handle error */ break;
-    }
-}
-
-void mos6507_get_register(mos6507_register_t reg, uint8_t *value)
-{
-    switch(reg) {
-        case MOS6507_REG_A:  *value = cpu.A;  break;
-        case MOS6507_REG_Y:  *value = cpu.Y;  break;
-        case MOS6507_REG_X:  *value = cpu.X;  break;
-        case MOS6507_REG_PC: *value = cpu.PC; break;
-        case MOS6507_REG_S:  *value = cpu.S;  break;
-        case MOS6507_REG_P:  *value = cpu.P;  break;
-        default: /* Handle error */ break;
-    }
+    cpu->PC  = 0;
+    cpu->PC |= (pch << 8);
+    cpu->PC |= pcl;
 }
 
-void mos6507_increment_PC(void)
+void mos6507_set_address_bus_hl(mos6507 *cpu, uint8_t adh, uint8_t adl)
 {
-    cpu.PC++;
+    cpu->address_bus  = 0;
+    cpu->address_bus |= (adh << 8);
+    cpu->address_bus |= adl;
 }
 
-uint16_t mos6507_get_PC(void)
+void mos6507_set_address_bus(mos6507 *cpu, uint16_t address)
 {
-    return cpu.PC;
+    cpu->address_bus = address;
 }
 
-void mos6507_set_PC(uint16_t pc)
+void mos6507_get_address_bus(mos6507 *cpu, uint16_t *address)
 {
-    cpu.PC = pc;
+    *address = cpu->address_bus;
 }
 
-void mos6507_set_PC_hl(uint8_t pch, uint8_t pcl)
+void mos6507_set_data_bus(mos6507 *cpu, uint8_t data)
 {
-    cpu.PC  = 0;
-    cpu.PC |= (pch << 8);
-    cpu.PC |= pcl;
+    cpu->data_bus = data;
 }
 
-void mos6507_set_address_bus_hl(uint8_t adh, uint8_t adl)
+void mos6507_get_data_bus(mos6507 *cpu, uint8_t *data)
 {
-    cpu.address_bus  = 0;
-    cpu.address_bus |= (adh << 8);
-    cpu.address_bus |= adl;
-}
-
-void mos6507_set_address_bus(uint16_t address)
-{
-    cpu.address_bus = address;
-}
-
-void mos6507_get_address_bus(uint16_t *address)
-{
-    *address = cpu.address_bus;
-}
-
-void mos6507_set_data_bus(uint8_t data)
-{
-    cpu.data_bus = data;
-}
-
-void mos6507_get_data_bus(uint8_t *data)
-{
-    *data = cpu.data_bus;
+    *data = cpu->data_bus;
 }
 
 char * mos6507_get_register_str(mos6507_register_t reg)
@@ -189,54 +165,39 @@ char * mos6507_get_register_str(mos6507_register_t reg)
     }
 }
 
-void mos6507_set_status_flag(mos6507_status_flag_t flag, int value) {
-    uint8_t status;
-    mos6507_get_register(MOS6507_REG_P, &status);
-    if (value) {
-        status |= flag;
-    } else {
-        status &= ~flag;
-    }
-    mos6507_set_register(MOS6507_REG_P, status);
-}
-
-int mos6507_get_status_flag(mos6507_status_flag_t flag) {
-    uint8_t status;
-    mos6507_get_register(MOS6507_REG_P, &status);
-    return (status & flag) ? 1 : 0;
-}
-
-void mos6507_get_current_instruction(uint8_t *instruction)
+void mos6507_get_current_instruction(mos6507 *cpu, uint8_t *instruction)
 {
-    *instruction = cpu.current_instruction;
+    *instruction = cpu->current_instruction;
 }
 
-void mos6507_get_current_instruction_cycle(uint8_t *instruction_cycle)
+void mos6507_get_current_instruction_cycle(mos6507 *cpu, uint8_t *instruction_cycle)
 {
-    *instruction_cycle = cpu.current_clock;
+    *instruction_cycle = cpu->current_clock;
 }
 
-void mos6507_push_stack(uint8_t byte)
+void mos6507_push_stack(atari2600_t *atari, uint8_t byte)
 {
+    mos6507 *cpu = &atari->cpu;
     uint8_t S;
-    mos6507_get_register(MOS6507_REG_S, &S);
-    mos6507_set_address_bus_hl(STACK_PAGE, S);
-    mos6507_set_data_bus(byte);
-    memmap_write();
-    mos6507_set_register(MOS6507_REG_S, S-1);
+    mos6507_get_register(cpu, MOS6507_REG_S, &S);
+    mos6507_set_address_bus_hl(cpu, STACK_PAGE, S);
+    mos6507_set_data_bus(cpu, byte);
+    memmap_write(atari);
+    mos6507_set_register(cpu, MOS6507_REG_S, S-1);
 #ifdef PRINT_STATE
-    debug_print_stack_action(DEBUG_STACK_ACTION_PUSH);
+    debug_print_stack_action(atari, DEBUG_STACK_ACTION_PUSH);
 #endif
 }
 
-void mos6507_pull_stack(uint8_t *byte)
+void mos6507_pull_stack(atari2600_t *atari, uint8_t *byte)
 {
+    mos6507 *cpu = &atari->cpu;
     uint8_t S;
-    mos6507_get_register(MOS6507_REG_S, &S);
-    mos6507_set_address_bus_hl(STACK_PAGE, S+1);
-    memmap_read(byte);
-    mos6507_set_register(MOS6507_REG_S, S+1);
+    mos6507_get_register(cpu, MOS6507_REG_S, &S);
+    mos6507_set_address_bus_hl(cpu, STACK_PAGE, S+1);
+    memmap_read(atari, byte);
+    mos6507_set_register(cpu, MOS6507_REG_S, S+1);
 #ifdef PRINT_STATE
-    debug_print_stack_action(DEBUG_STACK_ACTION_PULL);
+    debug_print_stack_action(atari, DEBUG_STACK_ACTION_PULL);
 #endif /* PRINT_STATE */
 }
@@ -11,10 +11,12 @@
 #define _MOS6507_H
 
 #include <stdint.h>
-#include "mos6507-opcodes.h"
 
 #define STACK_PAGE 0x01
 
+/* The console the CPU sits in, see atari/Atari-2600.h */
+typedef struct atari2600 atari2600_t;
+
 typedef enum {
     MOS6507_STATUS_FLAG_NEGATIVE  = 0x80,
     MOS6507_STATUS_FLAG_OVERFLOW  = 0x40,
@@ -41,34 +43,148 @@ typedef struct {
     uint8_t  X;   /* X register */
     uint16_t PC;  /* Program counter */
     uint8_t  S;   /* Stack pointer */
-    uint8_t  P;   /* Status register */
+    uint8_t  P;   /* Status register, less the flags below */
+    /* The flags nearly every instruction changes are kept apart from P so
+     * they're simple stores. N and Z hold the last result byte and are only
+     * turned into flags when something looks at them.
+     */
+    uint8_t  N;   /* Negative when bit 7 is set */
+    uint8_t  Z;   /* Zero when this is zero */
+    uint8_t  C;   /* Carry, 0 or 1 */
+    uint8_t  V;   /* Overflow, 0 or 1 */
     /* State description */
     uint8_t       current_instruction; /* Current op-code and addressing mode */
     uint8_t       current_clock;       /* Current clock tick of the current instruction */
     uint16_t      address_bus;         /* Address bus */
     uint8_t       data_bus;            /* Data bus */
+    /* In-flight op-code state, carried between clock ticks */
+    uint8_t  adl, adh;  /* Effective address */
+    uint8_t  bal, bah;  /* Base address of indexed modes */
+    uint8_t  ial;       /* Zero page pointer of indirect modes */
+    uint8_t  data;      /* Operand fetched from memory */
+    uint8_t  offset;    /* Relative branch offset */
+    uint16_t addr;      /* Branch destination */
+    uint8_t  pcl, pch;  /* Program counter moving to or from the stack */
 } mos6507;
 
-void mos6507_init(void);
-void mos6507_reset(void);
-int mos6507_clock_tick(void);
-void mos6507_set_register(mos6507_register_t reg, uint8_t value);
-void mos6507_get_register(mos6507_register_t reg, uint8_t *value);
-void mos6507_set_address_bus_hl(uint8_t adh, uint8_t adl);
-void mos6507_set_address_bus(uint16_t address);
-void mos6507_get_address_bus(uint16_t *address);
-void mos6507_set_data_bus(uint8_t data);
-void mos6507_get_data_bus(uint8_t *data);
-void mos6507_increment_PC(void);
-uint16_t mos6507_get_PC(void);
-void mos6507_set_PC(uint16_t pc);
-void mos6507_set_PC_hl(uint8_t pch, uint8_t pcl);
-void mos6507_set_status_flag(mos6507_status_flag_t flag, int value);
-int mos6507_get_status_flag(mos6507_status_flag_t flag);
+/* Op-code handlers operate on the model above */
+#include "mos6507-opcodes.h"
+
+/* Flags stored in P rather than their own fields */
+#define MOS6507_STATUS_FLAGS_LAZY (MOS6507_STATUS_FLAG_NEGATIVE | MOS6507_STATUS_FLAG_OVERFLOW | \
+                                   MOS6507_STATUS_FLAG_ZERO | MOS6507_STATUS_FLAG_CARRY)
+
+void mos6507_init(mos6507 *cpu);
+void mos6507_reset(atari2600_t *atari);
+int mos6507_clock_tick(atari2600_t *atari);
+void mos6507_set_address_bus_hl(mos6507 *cpu, uint8_t adh, uint8_t adl);
+void mos6507_set_address_bus(mos6507 *cpu, uint16_t address);
+void mos6507_get_address_bus(mos6507 *cpu, uint16_t *address);
+void mos6507_set_data_bus(mos6507 *cpu, uint8_t data);
+void mos6507_get_data_bus(mos6507 *cpu, uint8_t *data);
+void mos6507_set_PC_hl(mos6507 *cpu, uint8_t pch, uint8_t pcl);
 char * mos6507_get_register_str(mos6507_register_t reg);
-void mos6507_get_current_instruction(uint8_t *instruction);
-void mos6507_get_current_instruction_cycle(uint8_t *instruction_cycle);
-void mos6507_push_stack(uint8_t byte);
-void mos6507_pull_stack(uint8_t *byte);
+void mos6507_get_current_instruction(mos6507 *cpu, uint8_t *instruction);
+void mos6507_get_current_instruction_cycle(mos6507 *cpu, uint8_t *instruction_cycle);
+void mos6507_push_stack(atari2600_t *atari, uint8_t byte);
+void mos6507_pull_stack(atari2600_t *atari, uint8_t *byte);
+
+/* Sets N and Z from a result, as most instructions do */
+static inline void mos6507_set_NZ(mos6507 *cpu, uint8_t value)
+{
+    cpu->N = value;
+    cpu->Z = value;
+}
+
+/* Assembles the status register, e.g. to push it */
+static inline uint8_t mos6507_get_P(mos6507 *cpu)
+{
+    return (cpu->P & ~MOS6507_STATUS_FLAGS_LAZY) |
+           (cpu->N & MOS6507_STATUS_FLAG_NEGATIVE) |
+           (cpu->V ? MOS6507_STATUS_FLAG_OVERFLOW : 0) |
+           (cpu->Z ? 0 : MOS6507_STATUS_FLAG_ZERO) |
+           (cpu->C ? MOS6507_STATUS_FLAG_CARRY : 0);
+}
+
+static inline void mos6507_set_P(mos6507 *cpu, uint8_t value)
+{
+    cpu->P = value & ~MOS6507_STATUS_FLAGS_LAZY;
+    cpu->N = value;
+    cpu->V = (value & MOS6507_STATUS_FLAG_OVERFLOW) ? 1 : 0;
+    cpu->Z = (value & MOS6507_STATUS_FLAG_ZERO) ? 0 : 1;
+    cpu->C = value & MOS6507_STATUS_FLAG_CARRY;
+}
+
+/* The register is almost always a constant, so these fold away to a plain
+ * access of the field
+ */
+static inline void mos6507_set_register(mos6507 *cpu, mos6507_register_t reg, uint8_t value)
+{
+    switch(reg) {
+        case MOS6507_REG_A:  cpu->A  = value; break;
+        case MOS6507_REG_Y:  cpu->Y  = value; break;
+        case MOS6507_REG_X:  cpu->X  = value; break;
+        case MOS6507_REG_PC: cpu->PC = value; break;
+        case MOS6507_REG_S:  cpu->S  = value; break;
+        case MOS6507_REG_P:  mos6507_set_P(cpu, value); break;
+        default: /* Handle error */ break;
+    }
+}
+
+static inline void mos6507_get_register(mos6507 *cpu, mos6507_register_t reg, uint8_t *value)
+{
+    switch(reg) {
+        case MOS6507_REG_A:  *value = cpu->A;  break;
+        case MOS6507_REG_Y:  *value = cpu->Y;  break;
+        case MOS6507_REG_X:  *value = cpu->X;  break;
+        case MOS6507_REG_PC: *value = cpu->PC; break;
+        case MOS6507_REG_S:  *value = cpu->S;  break;
+        case MOS6507_REG_P:  *value = mos6507_get_P(cpu); break;
+        default: /* Handle error */ *value = 0; break;
+    }
+}
+
+static inline void mos6507_set_status_flag(mos6507 *cpu, mos6507_status_flag_t flag, int value)
+{
+    switch (flag) {
+        case MOS6507_STATUS_FLAG_NEGATIVE: cpu->N = value ? 0x80 : 0; break;
+        case MOS6507_STATUS_FLAG_OVERFLOW: cpu->V = value ? 1 : 0;    break;
+        case MOS6507_STATUS_FLAG_ZERO:     cpu->Z = value ? 0 : 1;    break;
+        case MOS6507_STATUS_FLAG_CARRY:    cpu->C = value ? 1 : 0;    break;
+        default:
+            if (value) {
+                cpu->P |= flag;
+            } else {
+                cpu->P &= ~flag;
+            }
+            break;
+    }
+}
+
+static inline int mos6507_get_status_flag(mos6507 *cpu, mos6507_status_flag_t flag)
+{
+    switch (flag) {
+        case MOS6507_STATUS_FLAG_NEGATIVE: return cpu->N >> 7;
+        case MOS6507_STATUS_FLAG_OVERFLOW: return cpu->V;
+        case MOS6507_STATUS_FLAG_ZERO:     return !cpu->Z;
+        case MOS6507_STATUS_FLAG_CARRY:    return cpu->C;
+        default:                           return (cpu->P & flag) ? 1 : 0;
+    }
+}
+
+static inline void mos6507_increment_PC(mos6507 *cpu)
+{
+    cpu->PC++;
+}
+
+static inline uint16_t mos6507_get_PC(mos6507 *cpu)
+{
+    return cpu->PC;
+}
+
+static inline void mos6507_set_PC(mos6507 *cpu, uint16_t pc)
+{
+    cpu->PC = pc;
+}
 
 #endif /* _MOS6507_H */
@@ -11,176 +11,184 @@
 #include "../mos6507/mos6507.h"
 #include "mos6532.h"
 
-static uint8_t memory[MEM_SIZE];
-mos6532_timer_t timer;
-uint8_t joy1_state = 0xFF;
-uint8_t switches_state = 0b00001011;
-
-void mos6532_init(void)
+void mos6532_init(mos6532 *riot)
 {
-    timer = (mos6532_timer_t){0};
-    timer.timer_set = MOS6532_TIMER_DIVISOR_NONE;
-    timer.interval_timer = 0;
-    timer.counter = 0;
-    mos6532_clear_memory();
+    riot->timer = (mos6532_timer_t){0};
+    riot->timer.timer_set = MOS6532_TIMER_DIVISOR_NONE;
+    riot->cycle = 0;
+    riot->joy1_state = 0xFF;
+    riot->switches_state = 0b00001011;
+    mos6532_clear_memory(riot);
 }
 
-/* Checks that a requested memory address is within the 
- * RAM space.
- *
- * address: address to verify.
- *
- * Returns 0 on success, -1 on error.
+/* Resets all RAM to zero
  */
-int mos6532_bounds_check(uint16_t address)
+void mos6532_clear_memory(mos6532 *riot)
 {
-    if (address > MEM_SIZE) {
-        return -1;
-    }
-    /* Flag an error */
-    return 0;
+    memset(riot->memory, 0, MEM_SIZE);
 }
 
-/* Resets all RAM to zero
+/* Works out the timer's count and whether it has expired as of a cycle.
+ *
+ * Once written with N the count drops by one every divisor ticks, reaching
+ * zero after N * divisor ticks and flagging the timer as expired. A
+ * divisor later it wraps to 0xFF and from then on drops every tick. Until
+ * it is first written it counts down every tick from reset.
  */
-void mos6532_clear_memory(void)
+static void mos6532_timer_state(mos6532 *riot, uint64_t cycle, uint8_t *counter, uint8_t *fired)
 {
-    memset(memory, 0, MEM_SIZE);
+    const mos6532_timer_t *timer = &riot->timer;
+    uint64_t elapsed = cycle - timer->set_cycle;
+    uint64_t expiry = (uint64_t)timer->start << timer->shift;
+    uint64_t divisor = (uint64_t)1 << timer->shift;
+
+    if (timer->timer_set == MOS6532_TIMER_DIVISOR_NONE) {
+        *counter = (uint8_t)(timer->start - elapsed);
+        *fired = 0;
+    } else if (elapsed < expiry) {
+        *counter = (uint8_t)(timer->start - (elapsed >> timer->shift));
+        *fired = 0;
+    } else if (elapsed < expiry + divisor) {
+        *counter = 0;
+        *fired = elapsed ? 1 : 0;
+    } else {
+        *counter = (uint8_t)(0xFF - (elapsed - expiry - divisor));
+        *fired = 1;
+    }
 }
 
 /* Loads a value from within RAM and places it into 
- * a variable given by pointer.
+ * a variable given by pointer, as it reads on the given cycle.
+ *
+ * The chip only decodes part of the address: A9 selects the I/O and timer
+ * registers over RAM, then A2 selects the timer over the I/O ports. Any
+ * mirror of a location therefore reaches the same register.
  *
  * Returns 0 on success, -1 on error.
  */
-int mos6532_read(uint16_t address, uint8_t *data)
+static int mos6532_read_at(mos6532 *riot, uint16_t address, uint64_t cycle, uint8_t *data)
 {
-    mos6532_map_mirrored_addresses(&address);
-    /* Check whether special peripheral registers are the target of the read
-     * before passing over to the general RAM area.
-     */
-    switch (address) {
+    if (!(address & MOS6532_SELECT_IO)) {
+        *data = riot->memory[address & MOS6532_RAM_MASK];
+        return 0;
+    }
+    if (address & MOS6532_SELECT_TIMER) {
+        uint8_t counter, fired;
+
+        mos6532_timer_state(riot, cycle, &counter, &fired);
+        if (address & 0x01) {
+            /* TIMINT, D7 is set once the timer has expired */
+            *data = fired ? 0x80 : 0x00;
+        } else {
+            *data = counter;
+        }
+        return 0;
+    }
+    switch (SWCHA + (address & MOS6532_PORT_MASK)) {
         case SWCHA:
-            *data = joy1_state;
-            return 0;
-        case SWACNT:
-            *data = 0x00;
+            *data = riot->joy1_state;
             return 0;
         case SWCHB:
-            *data = switches_state;
+            *data = riot->switches_state;
             return 0;
+        case SWACNT:
         case SWBCNT:
             *data = 0x00;
             return 0;
-        case MOS6532_MEMMAP_INTIM:
-            *data = timer.counter;
-            return 0;
-    }
-    if (-1 == mos6532_bounds_check(address)) {
-        /* Error, attempting to read outside memory */
-        return -1;
     }
-    *data = memory[address];
-    return 0;
+    return -1;
 }
 
-int mos6532_set_timer(mos6532_timer_divisor_t divisor, uint8_t data)
+int mos6532_read(mos6532 *riot, uint16_t address, uint8_t *data)
 {
-    timer.timer_set = divisor;
-    timer.interval_timer = divisor;
-    timer.counter = data;
-    timer.fired = 0;
+    return mos6532_read_at(riot, address, riot->cycle, data);
 }
 
-/* Writes to a RAM address.
+/* Reads an address as it will be the given number of ticks from now,
+ * assuming nothing is written in the meantime. Nothing is changed, so it
+ * can be used to look ahead at how the timer will count.
  *
  * Returns 0 on success, -1 on error.
  */
-int mos6532_write(uint16_t address, uint8_t data)
+int mos6532_peek(mos6532 *riot, uint16_t address, uint32_t ahead, uint8_t *data)
 {
-    mos6532_map_mirrored_addresses(&address);
-    /* Check whether special peripheral registers are the target of the write
-     * before passing over to the general RAM area.
-     */
-    switch (address) {
-        case SWCHA:
-        joy1_state = data;
-            return 0;
-        case SWCHB:
-        switches_state = data;
-        return 0;
-        case SWACNT:
-        case SWBCNT:
-            return 0;
-        case MOS6532_MEMMAP_TIM1T:
-            mos6532_set_timer(MOS6532_TIMER_DIVISOR_T1, data);
-            return 0;
-        case MOS6532_MEMMAP_TIM8T:
-            mos6532_set_timer(MOS6532_TIMER_DIVISOR_T8, data);
-            return 0;
-        case MOS6532_MEMMAP_TIM64T:
-            mos6532_set_timer(MOS6532_TIMER_DIVISOR_T64, data);
-            return 0;
-        case MOS6532_MEMMAP_TIM1024T:
-            mos6532_set_timer(MOS6532_TIMER_DIVISOR_T1024, data);
-            return 0;
-    }
-    if (-1 == mos6532_bounds_check(address)) {
-        /* Error, attempting to write outside memory */
-        return -1;
+    return mos6532_read_at(riot, address, riot->cycle + ahead, data);
+}
+
+int mos6532_set_timer(mos6532 *riot, mos6532_timer_divisor_t divisor, uint8_t data)
+{
+    riot->timer.timer_set = divisor;
+    riot->timer.set_cycle = riot->cycle;
+    riot->timer.start = data;
+    switch (divisor) {
+        case MOS6532_TIMER_DIVISOR_T8:    riot->timer.shift = 3;  break;
+        case MOS6532_TIMER_DIVISOR_T64:   riot->timer.shift = 6;  break;
+        case MOS6532_TIMER_DIVISOR_T1024: riot->timer.shift = 10; break;
+        default:                          riot->timer.shift = 0;  break;
     }
-    memory[address] = data;
     return 0;
 }
 
-void mos6532_timer_interval(mos6532_timer_divisor_t divisor)
+/* Writes to a RAM address, decoded the same way as mos6532_read().
+ *
+ * Returns 0 on success, -1 on error.
+ */
+int mos6532_write(mos6532 *riot, uint16_t address, uint8_t data)
 {
-    timer.interval_timer--;
-    if (timer.interval_timer == 0) {
-        timer.interval_timer = timer.timer_set;
-        timer.counter--;
-        if (timer.fired == 1) {
-            timer.timer_set = MOS6532_TIMER_DIVISOR_NONE;
+    if (!(address & MOS6532_SELECT_IO)) {
+        riot->memory[address & MOS6532_RAM_MASK] = data;
+        return 0;
+    }
+    if (address & MOS6532_SELECT_TIMER) {
+        /* With A4 clear this sets up PA7 edge detection, which isn't
+         * emulated.
+         */
+        if (!(address & MOS6532_SELECT_TIMER_WRITE)) {
+            return 0;
+        }
+        switch (MOS6532_MEMMAP_TIM1T + (address & MOS6532_PORT_MASK)) {
+            case MOS6532_MEMMAP_TIM1T:
+                mos6532_set_timer(riot, MOS6532_TIMER_DIVISOR_T1, data);
+                return 0;
+            case MOS6532_MEMMAP_TIM8T:
+                mos6532_set_timer(riot, MOS6532_TIMER_DIVISOR_T8, data);
+                return 0;
+            case MOS6532_MEMMAP_TIM64T:
+                mos6532_set_timer(riot, MOS6532_TIMER_DIVISOR_T64, data);
+                return 0;
+            case MOS6532_MEMMAP_TIM1024T:
+                mos6532_set_timer(riot, MOS6532_TIMER_DIVISOR_T1024, data);
+                return 0;
         }
     }
-    if (timer.counter == 0) {
-        timer.fired = 1;
+    switch (SWCHA + (address & MOS6532_PORT_MASK)) {
+        case SWCHA:
+            riot->joy1_state = data;
+            return 0;
+        case SWCHB:
+            riot->switches_state = data;
+            return 0;
+        case SWACNT:
+        case SWBCNT:
+            return 0;
     }
+    return -1;
 }
 
-void mos6532_clock_tick(void)
+void mos6532_get_interval(mos6532 *riot, mos6532_timer_divisor_t *divisor)
 {
-    switch (timer.timer_set) {
-        case MOS6532_TIMER_DIVISOR_T1:
-            mos6532_timer_interval(MOS6532_TIMER_DIVISOR_T1);
-            break;
-        case MOS6532_TIMER_DIVISOR_T8:
-            mos6532_timer_interval(MOS6532_TIMER_DIVISOR_T8);
-            break;
-        case MOS6532_TIMER_DIVISOR_T64:
-            mos6532_timer_interval(MOS6532_TIMER_DIVISOR_T64);
-            break;
-        case MOS6532_TIMER_DIVISOR_T1024:
-            mos6532_timer_interval(MOS6532_TIMER_DIVISOR_T1024);
-            break;
-        case MOS6532_TIMER_DIVISOR_NONE:
-            timer.counter--;
-            break;
-        default:
-            /* No timer set */
-            break;
-    }
-}
-
+    uint8_t counter, fired;
 
-void mos6532_get_interval(mos6532_timer_divisor_t *divisor)
-{
-    *divisor = timer.timer_set;
+    /* Once expired the timer counts down every tick */
+    mos6532_timer_state(riot, riot->cycle, &counter, &fired);
+    *divisor = fired ? MOS6532_TIMER_DIVISOR_NONE : riot->timer.timer_set;
 }
 
-void mos6532_get_counter(uint8_t *counter)
+void mos6532_get_counter(mos6532 *riot, uint8_t *counter)
 {
-    *counter = timer.counter;
+    uint8_t fired;
+
+    mos6532_timer_state(riot, riot->cycle, counter, &fired);
 }
 
 char * mos6532_get_divisor_str(mos6532_timer_divisor_t divisor)
@@ -193,11 +201,3 @@ char * mos6532_get_divisor_str(mos6532_timer_divisor_t divisor)
         default:             return "Unknown";
     }
 }
-
-void mos6532_map_mirrored_addresses(uint16_t *address)
-{
-    if (*address & 0x0100) {
-        *address &= 0x00FF;
-    }
-}
-
@@ -28,6 +28,13 @@ typedef enum {
 #define MOS6532_MEMMAP_TIM64T   0x296
 #define MOS6532_MEMMAP_TIM1024T 0x297
 
+/* Address lines the chip decodes internally */
+#define MOS6532_SELECT_IO          0x200 /* A9: I/O and timer rather than RAM */
+#define MOS6532_SELECT_TIMER       0x004 /* A2: Timer rather than I/O ports */
+#define MOS6532_SELECT_TIMER_WRITE 0x010 /* A4: Timer set rather than edge detect */
+#define MOS6532_RAM_MASK           0x07F
+#define MOS6532_PORT_MASK          0x003
+
 
 
 typedef enum {
@@ -38,29 +45,49 @@ typedef enum {
     MOS6532_TIMER_DIVISOR_T1024 = 1024
 } mos6532_timer_divisor_t;
 
+/* The timer isn't stepped; it records when it was set and works out its
+ * value from the time whenever it's read
+ */
 typedef struct {
-    uint8_t counter;
-    uint8_t interval_timer;
-    uint8_t fired;
+    uint64_t set_cycle; /* Clock tick on which it was written */
+    uint8_t start;      /* Value written */
+    uint8_t shift;      /* log2 of the divisor */
     mos6532_timer_divisor_t timer_set;
 } mos6532_timer_t;
 
-//mos6532_timer_t timer;
+/* Define a structure type to represent the state of a RIOT chip */
+typedef struct {
+    uint8_t memory[MEM_SIZE];
+    mos6532_timer_t timer;
+    uint64_t cycle; /* Clock ticks since reset */
+    uint8_t joy1_state;
+    uint8_t switches_state;
+} mos6532;
 
 /* Utility functions */
-int mos6532_bounds_check(uint16_t address);
-void mos6532_clear_memory(void);
-void mos6532_init(void);
-int mos6532_set_timer(mos6532_timer_divisor_t divisor, uint8_t data);
-void mos6532_timer_interval(mos6532_timer_divisor_t divisor);
+void mos6532_clear_memory(mos6532 *riot);
+void mos6532_init(mos6532 *riot);
+int mos6532_set_timer(mos6532 *riot, mos6532_timer_divisor_t divisor, uint8_t data);
 /* External memory access */
-int mos6532_read(uint16_t address, uint8_t *data);
-int mos6532_write(uint16_t address, uint8_t data);
-void mos6532_clock_tick(void);
-void mos6532_get_interval(mos6532_timer_divisor_t *divisor);
-void mos6532_get_counter(uint8_t *counter);
+int mos6532_read(mos6532 *riot, uint16_t address, uint8_t *data);
+int mos6532_peek(mos6532 *riot, uint16_t address, uint32_t ahead, uint8_t *data);
+int mos6532_write(mos6532 *riot, uint16_t address, uint8_t data);
+
+/* Advances the chip by one clock tick */
+static inline void mos6532_clock_tick(mos6532 *riot)
+{
+    riot->cycle++;
+}
+
+/* Advances the chip by a number of clock ticks at once */
+static inline void mos6532_run(mos6532 *riot, uint32_t cycles)
+{
+    riot->cycle += cycles;
+}
+
+void mos6532_get_interval(mos6532 *riot, mos6532_timer_divisor_t *divisor);
+void mos6532_get_counter(mos6532 *riot, uint8_t *counter);
 char * mos6532_get_divisor_str(mos6532_timer_divisor_t divisor);
-void mos6532_map_mirrored_addresses(uint16_t *address);
 
 #endif /* _MOS6532_H */
 
@@ -14,6 +14,7 @@
 //#include <string.h>
 //#include <unistd.h>
 #include "debug.h"
+#include "../atari/Atari-2600.h"
 #include "../atari/Atari-memmap.h"
 #include "../mos6532/mos6532.h"
 
@@ -243,10 +244,10 @@ debug_opcode_t debug_opcodes[] = {
 const uint8_t debug_opcode_table_size = sizeof debug_opcodes / sizeof debug_opcodes[0];
 
 #ifdef PRINT_STATE
-int debug_get_status_flag(uint8_t flag)
+int debug_get_status_flag(atari2600_t *atari, uint8_t flag)
 {
     uint8_t p;
-    mos6507_get_register(MOS6507_REG_P, &p);
+    mos6507_get_register(&atari->cpu, MOS6507_REG_P, &p);
     switch (flag) {
         case MOS6507_STATUS_FLAG_NEGATIVE:
             return (p & MOS6507_STATUS_FLAG_NEGATIVE);
@@ -267,7 +268,7 @@ int debug_get_status_flag(uint8_t flag)
     }
 }
 
-void debug_print_memory_contents(uint16_t address)
+void debug_print_memory_contents(atari2600_t *atari, uint16_t address)
 {
     char msg[MSG_LEN];
     memset(msg, 0, MSG_LEN);
@@ -279,15 +280,15 @@ void debug_print_memory_contents(uint16_t address)
     // Change the address bus to the specified location, read the data, then
     // revert back to what it was without a full CPU clock tick to make the 
     // read seamless
-    mos6507_get_address_bus(&current_address);
-    mos6507_set_address_bus(address);
-    memmap_read(&data);
-    mos6507_set_address_bus(current_address);
+    mos6507_get_address_bus(&atari->cpu, &current_address);
+    mos6507_set_address_bus(&atari->cpu, address);
+    memmap_read(atari, &data);
+    mos6507_set_address_bus(&atari->cpu, current_address);
     printf(template, address, address, data, data);
 //    puts(msg);
 }
 
-void debug_print_special_register(mos6507_register_t reg)
+void debug_print_special_register(atari2600_t *atari, mos6507_register_t reg)
 {
     char msg[MSG_LEN];
     memset(msg, 0, MSG_LEN);
@@ -298,16 +299,16 @@ void debug_print_special_register(mos6507_register_t reg)
     uint16_t longdata;
 
     if(reg == MOS6507_REG_PC) {
-       longdata = mos6507_get_PC();
+       longdata = mos6507_get_PC(&atari->cpu);
        printf(template, mos6507_get_register_str(reg), longdata, longdata);
     } else {
-        mos6507_get_register(reg, &data);
+        mos6507_get_register(&atari->cpu, reg, &data);
         printf(template, mos6507_get_register_str(reg), data, data);
     }
 //    puts(msg);
 }
 
-void debug_print_status_flags(void)
+void debug_print_status_flags(atari2600_t *atari)
 {
     char msg[MSG_LEN];
     memset(msg, 0, MSG_LEN);
@@ -317,18 +318,18 @@ void debug_print_status_flags(void)
                      "|    %d   |     %d      |    %d    |     %d     |      %d      |   %d    |    %d    |\n\r";
 
     printf(template,
-            mos6507_get_status_flag(MOS6507_STATUS_FLAG_NEGATIVE),
-            mos6507_get_status_flag(MOS6507_STATUS_FLAG_OVERFLOW),
-            mos6507_get_status_flag(MOS6507_STATUS_FLAG_BREAK),
-            mos6507_get_status_flag(MOS6507_STATUS_FLAG_DECIMAL),
-            mos6507_get_status_flag(MOS6507_STATUS_FLAG_INTERRUPT),
-            mos6507_get_status_flag(MOS6507_STATUS_FLAG_ZERO),
-            mos6507_get_status_flag(MOS6507_STATUS_FLAG_CARRY));
+            mos6507_get_status_flag(&atari->cpu, MOS6507_STATUS_FLAG_NEGATIVE),
+            mos6507_get_status_flag(&atari->cpu, MOS6507_STATUS_FLAG_OVERFLOW),
+            mos6507_get_status_flag(&atari->cpu, MOS6507_STATUS_FLAG_BREAK),
+            mos6507_get_status_flag(&atari->cpu, MOS6507_STATUS_FLAG_DECIMAL),
+            mos6507_get_status_flag(&atari->cpu, MOS6507_STATUS_FLAG_INTERRUPT),
+            mos6507_get_status_flag(&atari->cpu, MOS6507_STATUS_FLAG_ZERO),
+            mos6507_get_status_flag(&atari->cpu, MOS6507_STATUS_FLAG_CARRY));
 
 //    puts(msg);
 }
 
-void debug_print_buses(void)
+void debug_print_buses(atari2600_t *atari)
 {
     char msg[MSG_LEN];
     memset(msg, 0, MSG_LEN);
@@ -336,8 +337,8 @@ void debug_print_buses(void)
     uint16_t offset_address;
     uint8_t data;
     char *subsystem;
-    mos6507_get_data_bus(&data);
-    mos6507_get_address_bus(&address);
+    mos6507_get_data_bus(&atari->cpu, &data);
+    mos6507_get_address_bus(&atari->cpu, &address);
 
     memmap_map_address(&address);
 
@@ -360,15 +361,15 @@ void debug_print_buses(void)
 //    puts(msg);
 }
 
-void debug_print_instruction(void)
+void debug_print_instruction(atari2600_t *atari)
 {
     char msg[MSG_LEN];
     memset(msg, 0, MSG_LEN);
 
     uint8_t instruction, cycle;
 
-    mos6507_get_current_instruction(&instruction);
-    mos6507_get_current_instruction_cycle(&cycle);
+    mos6507_get_current_instruction(&atari->cpu, &instruction);
+    mos6507_get_current_instruction_cycle(&atari->cpu, &cycle);
 
     char * template = "Instruction [ 0x%X, %s ], cycle: %d\n\r";
 
@@ -376,19 +377,19 @@ void debug_print_instruction(void)
 //    puts(msg);
 }
 
-void debug_print_illegal_opcode(uint8_t opcode)
+void debug_print_illegal_opcode(atari2600_t *atari, uint8_t opcode)
 {
     char msg[MSG_LEN];
     memset(msg, 0, MSG_LEN);
 
-    char * template = "\n\r!!! Error: Illegal opcode [ 0x%X ] !!!\n\r";
+    char * template = "\n\r!!! Error: CPU jammed on opcode [ 0x%X ] !!!\n\r";
 
     printf(template, opcode);
 //    puts(msg);
-    debug_print_execution_step();
+    debug_print_execution_step(atari);
 }
 
-void debug_print_stack_action(debug_stack_action_t action)
+void debug_print_stack_action(atari2600_t *atari, debug_stack_action_t action)
 {
     char msg[MSG_LEN];
     memset(msg, 0, MSG_LEN);
@@ -396,8 +397,8 @@ void debug_print_stack_action(debug_stack_action_t action)
     uint8_t data;
     char * template = "%s stack ..\n\r%s\tStack address: 0x%X, data: 0x%X\n\r";
 
-    mos6507_get_address_bus(&address);
-    mos6507_get_data_bus(&data);
+    mos6507_get_address_bus(&atari->cpu, &address);
+    mos6507_get_data_bus(&atari->cpu, &data);
 
     puts("----------------------\n\r");
     if (action == DEBUG_STACK_ACTION_PUSH) {
@@ -409,7 +410,7 @@ void debug_print_stack_action(debug_stack_action_t action)
 //    puts(msg);
 }
 
-void debug_print_stack()
+void debug_print_stack(atari2600_t *atari)
 {
     char msg[MSG_LEN];
     memset(msg, 0, MSG_LEN);
@@ -418,9 +419,9 @@ void debug_print_stack()
 
     uint16_t address_bus;
     uint8_t i, sp, data_bus, data;
-    mos6507_get_address_bus(&address_bus);
-    mos6507_get_data_bus(&data_bus);
-    mos6507_get_register(MOS6507_REG_S, &sp);
+    mos6507_get_address_bus(&atari->cpu, &address_bus);
+    mos6507_get_data_bus(&atari->cpu, &data_bus);
+    mos6507_get_register(&atari->cpu, MOS6507_REG_S, &sp);
 
     puts("----------------------\n\r");
 
@@ -432,18 +433,18 @@ void debug_print_stack()
         puts("Stack empty\n\r");
     } else {
         for (i=0xFF; i>sp; i--) {
-            mos6507_set_address_bus_hl(STACK_PAGE, i);
-            memmap_read(&data);
+            mos6507_set_address_bus_hl(&atari->cpu, STACK_PAGE, i);
+            memmap_read(atari, &data);
             printf(template, i, data);
         //    puts(msg);
         }
     }
 
-    mos6507_set_address_bus(address_bus);
-    mos6507_set_data_bus(data_bus);
+    mos6507_set_address_bus(&atari->cpu, address_bus);
+    mos6507_set_data_bus(&atari->cpu, data_bus);
 }
 
-void debug_print_timer()
+void debug_print_timer(atari2600_t *atari)
 {
     char msg[MSG_LEN];
     memset(msg, 0, MSG_LEN);
@@ -453,8 +454,8 @@ void debug_print_timer()
 
     char * template = "Timer [ %s SET: %d ], interval: %s\n\r";
 
-    mos6532_get_counter(&counter);
-    mos6532_get_interval(&divisor);
+    mos6532_get_counter(&atari->riot, &counter);
+    mos6532_get_interval(&atari->riot, &divisor);
 
     printf(template,
             (counter ? "" : "NOT"),
@@ -463,21 +464,21 @@ void debug_print_timer()
 //    puts(msg);
 }
 
-void debug_print_execution_step(void)
+void debug_print_execution_step(atari2600_t *atari)
 {
     printf("\n\r----------------------------------------------------------------"
          "---------------------\n\r");
 
-    debug_print_instruction();
-    debug_print_buses();
-    debug_print_special_register(MOS6507_REG_PC);
-    debug_print_special_register(MOS6507_REG_A);
-    debug_print_special_register(MOS6507_REG_S);
-    debug_print_special_register(MOS6507_REG_X);
-    debug_print_special_register(MOS6507_REG_Y);
-    debug_print_timer();
-    debug_print_status_flags();
-    debug_print_stack();
+    debug_print_instruction(atari);
+    debug_print_buses(atari);
+    debug_print_special_register(atari, MOS6507_REG_PC);
+    debug_print_special_register(atari, MOS6507_REG_A);
+    debug_print_special_register(atari, MOS6507_REG_S);
+    debug_print_special_register(atari, MOS6507_REG_X);
+    debug_print_special_register(atari, MOS6507_REG_Y);
+    debug_print_timer(atari);
+    debug_print_status_flags(atari);
+    debug_print_stack(atari);
 }
 
 const char * debug_lookup_opcode_str(uint8_t opcode)
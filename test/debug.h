@@ -26,18 +26,18 @@ typedef struct {
 } debug_opcode_t;
 
 const char * debug_lookup_opcode_str(uint8_t opcode);
-void debug_print_status_flags(void);
-void debug_print_memory_contents(uint16_t address);
-void debug_print_special_register(mos6507_register_t reg);
-void debug_print_buses(void);
-void debug_print_execution_step(void);
-int debug_get_status_flag(uint8_t flag);
-void debug_print_instruction(void);
-void debug_print_illegal_opcode(uint8_t opcode);
+void debug_print_status_flags(atari2600_t *atari);
+void debug_print_memory_contents(atari2600_t *atari, uint16_t address);
+void debug_print_special_register(atari2600_t *atari, mos6507_register_t reg);
+void debug_print_buses(atari2600_t *atari);
+void debug_print_execution_step(atari2600_t *atari);
+int debug_get_status_flag(atari2600_t *atari, uint8_t flag);
+void debug_print_instruction(atari2600_t *atari);
+void debug_print_illegal_opcode(atari2600_t *atari, uint8_t opcode);
 const char * debug_lookup_opcode_str(uint8_t opcode);
-void debug_print_stack_action(debug_stack_action_t action);
-void debug_print_stack();
-void debug_print_timer();
+void debug_print_stack_action(atari2600_t *atari, debug_stack_action_t action);
+void debug_print_stack(atari2600_t *atari);
+void debug_print_timer(atari2600_t *atari);
 
 #endif /* PRINT_STATE */
 